@@ -0,0 +1,452 @@
+// ============================================================
+// Host microbenchmarks for the Poems / Us / storage hot kernels.
+//   pio run -e bench && .pio/build/bench/program [name-filter]
+// Each case doubles its iteration count until it runs for at least
+// 250 ms, then reports ns/op and bytes/op (input bytes the kernel
+// consumes per call: source pixels, poem text, file names).
+// ============================================================
+
+#include <Arduino.h>
+#include <TFT_eSPI.h>
+#include <LittleFS.h>
+#include <chrono>
+#include <stdlib.h>
+#include <unistd.h>
+#include "poem_layout.h"
+#include "poem_raster.h"
+#include "subpixel.h"
+#include "band_push.h"
+#include "sdcard.h"
+#include "istore.h"
+#include "q565.h"
+
+TFT_eSPI tft = TFT_eSPI();
+
+static volatile uint32_t sink;
+
+// Runs `iters` operations, returns total input bytes consumed
+typedef uint64_t (*BenchFn)(uint32_t iters);
+
+struct Bench {
+  const char* name;
+  BenchFn fn;
+};
+
+// --- Inputs ---
+
+#define BENCH_POEM_LINES 512
+#define BENCH_POEM_PATH  "/bench.md"
+
+static PoemLayout layout;
+static char poemText[16384];
+static size_t poemLen = 0;
+static char fsDir[] = "/tmp/keychain-bench-XXXXXX";
+
+static uint16_t lineBody[SUBPIXEL_SRC_W * 28];
+static uint16_t lineTitle[SUBPIXEL_SRC_W * 28];
+static int bodyW = 0, titleW = 0;
+static uint8_t frame[SUBPIXEL_FRAME_BYTES];
+static PoemRaster raster;
+static int stripLine = 0;   // first body line of the bench poem
+
+// Deterministic 512-line poem (~8 KB, well past what fits on screen): mostly
+// short lines, every 8th line blank (stanza break), every 6th long enough to
+// wrap, with some headings, blockquotes, *emphasis* and **bold** mixed in.
+// Written to a scratch LittleFS root so the loader streams it.
+static void buildPoem() {
+  static const char* words[] = {
+    "moon", "river", "we", "carry", "small", "lanterns", "home", "through",
+    "winter", "wheat", "and", "every", "stone", "remembers", "light", "the",
+  };
+  uint32_t seed = 12345;
+  size_t n = snprintf(poemText, sizeof(poemText), "# The River Remembers Everything\n");
+  for (int line = 0; line < BENCH_POEM_LINES - 1; line++) {
+    char buf[96];
+    size_t len = 0;
+    int count = (line % 8 == 7) ? 0 : (line % 6 == 0) ? 6 : 2;
+    if (count && line % 16 == 3) len += snprintf(buf, sizeof(buf), "## ");
+    else if (count && line % 9 == 2) len += snprintf(buf, sizeof(buf), "> ");
+    for (int w = 0; w < count; w++) {
+      seed = seed * 1103515245u + 12345u;
+      const char* word = words[(seed >> 16) % 16];
+      const char* mark = (w == 1 && line % 5 == 1) ? "*" : (w == 1 && line % 7 == 4) ? "**" : "";
+      len += snprintf(buf + len, sizeof(buf) - len, w ? " %s%s%s" : "%s%s%s", mark, word, mark);
+    }
+    buf[len++] = '\n';
+    if (n + len >= sizeof(poemText)) break;
+    memcpy(poemText + n, buf, len);
+    n += len;
+  }
+  poemText[n] = '\0';
+  poemLen = n;
+
+  if (!mkdtemp(fsDir)) return;
+  simSetFsRoot(fsDir);
+  File f = LittleFS.open(BENCH_POEM_PATH, "w");
+  f.write((const uint8_t*)poemText, poemLen);
+  f.close();
+  buildPoemCache(BENCH_POEM_PATH);
+}
+
+#define BENCH_PHOTO_PATH "/bench.q565"
+
+static void removeInputs() {
+  LittleFS.remove(BENCH_PHOTO_PATH);
+  char cachePath[64];
+  poemCachePath(BENCH_POEM_PATH, cachePath, sizeof(cachePath));
+  LittleFS.remove(cachePath);
+  LittleFS.remove(BENCH_POEM_PATH);
+  rmdir(fsDir);
+}
+
+static void openBenchPoem(PoemLayout& L) {
+  openPoem(L, LittleFS.open(BENCH_POEM_PATH, "r"));
+}
+
+// Render one body line and one title line the way drawContent() does
+static void buildLines() {
+  TFT_eSprite spr(&tft);
+  spr.setColorDepth(16);
+  spr.createSprite(SUBPIXEL_SRC_W, 28);
+
+  const char* body = "we carry small lanterns home thro";
+  spr.fillSprite(TFT_BLACK);
+  spr.setTextColor(0xFFFF);
+  spr.setTextDatum(TL_DATUM);
+  spr.drawString(body, 0, 0, 2);
+  bodyW = spr.textWidth(body, 2);
+  memcpy(lineBody, spr.getPointer(), sizeof(lineBody));
+
+  const char* title = "Remembers";
+  spr.fillSprite(TFT_BLACK);
+  spr.setTextColor(0xE500);
+  spr.drawString(title, 0, 0, 4);
+  titleW = spr.textWidth(title, 4);
+  memcpy(lineTitle, spr.getPointer(), sizeof(lineTitle));
+}
+
+// Fill the layout ring from the bench poem and rasterize it for the strip cases
+static void buildRaster() {
+  TFT_eSprite spr(&tft);
+  spr.setColorDepth(16);
+  spr.createSprite(SUBPIXEL_SRC_W, TITLE_LINE_H);
+  openBenchPoem(layout);
+  while (nextPoemLine(layout)) {}
+  initPoemRaster(raster);
+  for (int n = layout.first; n < layout.count; n++) rasterizePoemLine(raster, layout, n, spr);
+  while (stripLine < layout.count && poemLine(layout, stripLine).type == LINE_TITLE) stripLine++;
+}
+
+// --- Cases ---
+
+static uint64_t blitAt(const uint16_t* src, int w, int h, int32_t fracQ, uint32_t iters) {
+  for (uint32_t i = 0; i < iters; i++) {
+    subPixelBlit(src, w, h, stripPalette, frame, toQ16(40) + fracQ, 100);
+  }
+  sink = frame[100 * 120 + 30];
+  return (uint64_t)iters * w * h * 2;
+}
+
+static uint64_t benchBlitBody0(uint32_t n)  { return blitAt(lineBody, bodyW, BODY_LINE_H, 0, n); }
+static uint64_t benchBlitBody25(uint32_t n) { return blitAt(lineBody, bodyW, BODY_LINE_H, Q16_ONE / 4, n); }
+static uint64_t benchBlitBody50(uint32_t n) { return blitAt(lineBody, bodyW, BODY_LINE_H, Q16_ONE / 2, n); }
+static uint64_t benchBlitBody75(uint32_t n) { return blitAt(lineBody, bodyW, BODY_LINE_H, Q16_ONE * 3 / 4, n); }
+static uint64_t benchBlitTitle(uint32_t n)  { return blitAt(lineTitle, titleW, TITLE_LINE_H, Q16_ONE / 2, n); }
+
+static uint64_t stripAt(int32_t fracQ, uint32_t iters) {
+  int i = stripLine, slot = i % POEM_RING;
+  for (uint32_t n = 0; n < iters; n++) {
+    subPixelBlitStrip(poemStrip(raster, i), raster.stride[slot], raster.width[slot],
+                      BODY_LINE_H, frame, toQ16(40) + fracQ, 100);
+  }
+  sink = frame[100 * 120 + 30];
+  return (uint64_t)iters * raster.stride[slot] * BODY_LINE_H * 4;
+}
+
+static uint64_t benchStrip0(uint32_t n)  { return stripAt(0, n); }
+static uint64_t benchStrip50(uint32_t n) { return stripAt(Q16_ONE / 2, n); }
+
+static uint64_t benchStripScalar50(uint32_t iters) {
+  int i = stripLine, slot = i % POEM_RING;
+  for (uint32_t n = 0; n < iters; n++) {
+    subPixelBlitStripScalar(poemStrip(raster, i), raster.stride[slot], raster.width[slot],
+                            BODY_LINE_H, frame, toQ16(40) + Q16_ONE / 2, 100);
+  }
+  sink = frame[100 * 120 + 30];
+  return (uint64_t)iters * raster.stride[slot] * BODY_LINE_H * 4;
+}
+
+// The word-at-a-time strip kernel must match the per-pixel reference for
+// every line of the poem, at fractional offsets and clipped against both
+// screen edges.  Streams the poem through its own ring.
+static bool verifyStripKernel() {
+  static PoemLayout vl;
+  static PoemRaster vr;
+  static uint8_t ref[SUBPIXEL_FRAME_BYTES];
+  static const float xs[] = {-7.5f, 0.0f, 0.1f, 3.25f, 17.5f, 40.75f, 100.875f, 230.5f};
+  TFT_eSprite spr(&tft);
+  spr.setColorDepth(16);
+  spr.createSprite(SUBPIXEL_SRC_W, TITLE_LINE_H);
+  openBenchPoem(vl);
+  if (!initPoemRaster(vr)) return false;
+  bool ok = true;
+  for (int i = 0; ok && (i < vl.count || nextPoemLine(vl)); i++) {
+    rasterizePoemLine(vr, vl, i, spr);
+    int h = lineHeight(poemLine(vl, i).type), slot = i % POEM_RING;
+    for (float xf : xs) {
+      int32_t x = (int32_t)(xf * Q16_ONE);
+      memset(frame, 0, sizeof(frame));
+      memset(ref, 0, sizeof(ref));
+      const uint32_t* strip = poemStrip(vr, i);
+      subPixelBlitStrip(strip, vr.stride[slot], vr.width[slot], h, frame, x, -3);
+      subPixelBlitStripScalar(strip, vr.stride[slot], vr.width[slot], h, ref, x, -3);
+      if (memcmp(frame, ref, sizeof(frame)) != 0) {
+        printf("MISMATCH subPixelBlitStrip line %d at x=%.3f\n", i, xf);
+        ok = false;
+        break;
+      }
+    }
+    dropPoemLine(vl);
+  }
+  closePoem(vl);
+  freePoemRaster(vr);
+  return ok;
+}
+
+// Per-frame cost of the non-rasterized path: draw the line, then blit it
+static uint64_t benchDrawAndBlit(uint32_t iters) {
+  TFT_eSprite spr(&tft);
+  spr.setColorDepth(16);
+  spr.createSprite(SUBPIXEL_SRC_W, TITLE_LINE_H);
+  int i = stripLine;
+  for (uint32_t n = 0; n < iters; n++) {
+    int w = drawPoemLine(spr, layout, i);
+    subPixelBlit((const uint16_t*)spr.getPointer(), w, BODY_LINE_H, stripPalette, frame, toQ16(40) + Q16_ONE / 2, 100);
+  }
+  sink = frame[100 * 120 + 30];
+  return (uint64_t)iters * poemLine(layout, i).width * BODY_LINE_H * 2;
+}
+
+static uint64_t benchRasterizeLine(uint32_t iters) {
+  TFT_eSprite spr(&tft);
+  spr.setColorDepth(16);
+  spr.createSprite(SUBPIXEL_SRC_W, TITLE_LINE_H);
+  for (uint32_t i = 0; i < iters; i++) rasterizePoemLine(raster, layout, stripLine, spr);
+  sink = poemStrip(raster, stripLine)[0];
+  return (uint64_t)iters * poemLine(layout, stripLine).width * BODY_LINE_H * 2;
+}
+
+// Open the poem and wrap every line through the ring, as a full scroll would
+static uint64_t benchStreamPoem(uint32_t iters) {
+  static PoemLayout sl;
+  for (uint32_t i = 0; i < iters; i++) {
+    openBenchPoem(sl);
+    for (;;) {
+      if (!nextPoemLine(sl)) {
+        if (sl.eof) break;
+        dropPoemLine(sl);
+      }
+    }
+  }
+  sink = sl.totalHeight;
+  closePoem(sl);
+  return (uint64_t)iters * poemLen;
+}
+
+// What a poem switch costs before the first frame: open, then lay out one
+// screen of lines, either by wrapping and measuring or from the cache
+static uint64_t openScreen(bool cached, uint32_t iters) {
+  static PoemLayout ol;
+  char cachePath[64];
+  poemCachePath(BENCH_POEM_PATH, cachePath, sizeof(cachePath));
+  for (uint32_t i = 0; i < iters; i++) {
+    if (cached) {
+      openPoemCached(ol, LittleFS.open(cachePath, "r"), BENCH_POEM_PATH, poemLen);
+    } else {
+      openBenchPoem(ol);
+    }
+    while (ol.nextY < 240 && nextPoemLine(ol)) {}
+  }
+  sink = ol.count;
+  closePoem(ol);
+  return 0;
+}
+
+static uint64_t benchOpenWrapped(uint32_t n) { return openScreen(false, n); }
+static uint64_t benchOpenCached(uint32_t n)  { return openScreen(true, n); }
+
+// CPU side of one band-pushed frame: expand every 4-bit band to RGB565
+static uint64_t benchBandRender(uint32_t iters) {
+  static uint16_t band[240 * BAND_ROWS];
+  static Band4 b4;
+  bandInit4(b4, frame, framePalette);
+  for (uint32_t i = 0; i < iters; i++) {
+    for (int b = 0; b < BAND_COUNT; b++) bandRender4(band, b * BAND_ROWS, BAND_ROWS, &b4);
+  }
+  sink = band[0];
+  return (uint64_t)iters * sizeof(frame);
+}
+
+// Photo-like 240x240 frame (SPI byte order): a sky gradient, a flat
+// band, and a noisy textured lower half, so every Q565 op turns up
+static uint16_t photo[Q565_PIXELS];
+static uint16_t photoOut[Q565_PIXELS];
+static size_t photoBytes = 0;
+
+static void buildPhoto() {
+  uint32_t seed = 777;
+  for (int y = 0; y < Q565_SIZE; y++) {
+    for (int x = 0; x < Q565_SIZE; x++) {
+      seed = seed * 1103515245u + 12345u;
+      int noise = (seed >> 16) % 5;
+      uint8_t r, g, b;
+      if (y < 100) {
+        r = 40 + y / 2; g = 90 + y; b = 230 - x / 8;
+      } else if (y < 120) {
+        r = g = b = 200;
+      } else {
+        r = 60 + (x * 3 + y) % 90 + noise * 6; g = 110 + ((x ^ y) & 31) + noise * 4; b = 50 + noise * 9;
+      }
+      uint16_t px = tft.color565(r, g, b);
+      photo[y * Q565_SIZE + x] = (uint16_t)(px >> 8 | px << 8);
+    }
+  }
+  File f = LittleFS.open(BENCH_PHOTO_PATH, "w");
+  q565Write(f, photo);
+  photoBytes = f.size();
+  f.close();
+}
+
+static bool verifyQ565() {
+  if (!q565DecodeFile(BENCH_PHOTO_PATH, LittleFS, photoOut) ||
+      memcmp(photo, photoOut, sizeof(photo)) != 0) {
+    printf("MISMATCH q565 round trip\n");
+    return false;
+  }
+  return true;
+}
+
+// Decode one Q565 photo from LittleFS into a frame (what a Us prefetch does)
+static uint64_t benchQ565Decode(uint32_t iters) {
+  for (uint32_t i = 0; i < iters; i++) q565DecodeFile(BENCH_PHOTO_PATH, LittleFS, photoOut);
+  sink = photoOut[0];
+  return (uint64_t)iters * photoBytes;
+}
+
+static uint64_t benchWordWrap(uint32_t iters) {
+  static const char* line =
+    "and every stone remembers light the river carries home through winter "
+    "wheat we carry small lanterns home through fields of winter wheat";
+  static PoemLayout wl;
+  size_t len = strlen(line);
+  for (uint32_t i = 0; i < iters; i++) {
+    wl.first = wl.count = 0;
+    wordWrap(wl, line, BODY_WRAP, LINE_BODY, LINE_WRAP);
+  }
+  sink = wl.count;
+  return (uint64_t)iters * len;
+}
+
+static uint64_t benchLeftEdge(uint32_t iters) {
+  int32_t acc = 0;
+  for (uint32_t i = 0; i < iters; i++) {
+    acc += leftEdgeQ16(toQ16(i % 240) + Q16_ONE * 9 / 10);
+  }
+  sink = (uint32_t)acc;
+  return 0;
+}
+
+static const char* names[] = {
+  "IMG_20240612_183355.jpg", "notes.md", "Birthday.JPEG", "README",
+  "a_very_long_poem_name_that_needs_truncating.md", ".hidden", "photo.png",
+  "no_extension_but_a_very_long_name_indeed_really", "sunset.q565",
+};
+static const int nameCount = sizeof(names) / sizeof(names[0]);
+
+static uint64_t benchClassifyFile(uint32_t iters) {
+  uint64_t bytes = 0;
+  uint32_t acc = 0;
+  for (uint32_t i = 0; i < iters; i++) {
+    const char* name = names[i % nameCount];
+    acc += classifyFile(name);
+    bytes += strlen(name);
+  }
+  sink = acc;
+  return bytes;
+}
+
+static uint64_t benchTruncateName(uint32_t iters) {
+  uint64_t bytes = 0;
+  char out[33];
+  for (uint32_t i = 0; i < iters; i++) {
+    const char* name = names[i % nameCount];
+    istoreTruncateName(name, out, sizeof(out));
+    bytes += strlen(name);
+  }
+  sink = out[0];
+  return bytes;
+}
+
+// The blit cases composite into the 4-bit frame, X in 1/SUBPIXEL_LEVELS
+// (1/4) px.  Figures from before it, 1/8 px into RGB332 through the fused
+// blend table, are not comparable.
+static const Bench benches[] = {
+  {"subPixelBlit/body+0.00", benchBlitBody0},
+  {"subPixelBlit/body+0.25", benchBlitBody25},
+  {"subPixelBlit/body+0.50", benchBlitBody50},
+  {"subPixelBlit/body+0.75", benchBlitBody75},
+  {"subPixelBlit/title+0.50", benchBlitTitle},
+  {"subPixelBlitStrip/body+0.00", benchStrip0},
+  {"subPixelBlitStrip/body+0.50", benchStrip50},
+  {"subPixelBlitStripScalar/body+0.50", benchStripScalar50},
+  {"drawPoemLine+blit/body+0.50", benchDrawAndBlit},
+  {"rasterizePoemLine/body", benchRasterizeLine},
+  {"streamPoem/512-lines", benchStreamPoem},
+  {"openPoem/first-screen", benchOpenWrapped},
+  {"openPoemCached/first-screen", benchOpenCached},
+  {"bandRender4/frame", benchBandRender},
+  {"q565Decode/frame", benchQ565Decode},
+  {"wordWrap/long-line", benchWordWrap},
+  {"leftEdgeQ16", benchLeftEdge},
+  {"classifyFile", benchClassifyFile},
+  {"istoreTruncateName", benchTruncateName},
+};
+
+// --- Harness ---
+
+static void run(const Bench& b) {
+  using clock = std::chrono::steady_clock;
+  uint32_t iters = 1;
+  double ns = 0;
+  uint64_t bytes = 0;
+  while (true) {
+    auto t0 = clock::now();
+    bytes = b.fn(iters);
+    ns = std::chrono::duration<double, std::nano>(clock::now() - t0).count();
+    if (ns >= 250e6 || iters >= (1u << 30)) break;
+    iters *= 2;
+  }
+  printf("%-34s %12u iters %12.1f ns/op %10.1f B/op\n",
+         b.name, iters, ns / iters, (double)bytes / iters);
+}
+
+int main(int argc, char** argv) {
+  const char* filter = argc > 1 ? argv[1] : nullptr;
+  simSetQuiet(true);
+  buildPoem();
+  buildLines();
+  buildRaster();
+  buildPhoto();
+  if (!verifyStripKernel() || !verifyQ565()) {
+    removeInputs();
+    return 1;
+  }
+
+  for (const Bench& b : benches) {
+    if (filter && !strstr(b.name, filter)) continue;
+    run(b);
+  }
+  closePoem(layout);
+  removeInputs();
+  return 0;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+// ============================================================
+// Host stand-in for the Arduino-ESP32 core (native simulator build)
+// Only the subset the firmware uses is provided. Time is virtual:
+// millis()/micros() only advance through delay() and the runner.
+// ============================================================
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <math.h>
+#include <algorithm>
+
+#define HIGH 1
+#define LOW  0
+
+#define INPUT        0x01
+#define OUTPUT       0x03
+#define INPUT_PULLUP 0x05
+
+#define RISING  0x01
+#define FALLING 0x02
+#define CHANGE  0x03
+
+#define PI     3.1415926535897932384626433832795
+#define HALF_PI 1.5707963267948966192313216916398
+#define TWO_PI 6.283185307179586476925286766559
+
+#define IRAM_ATTR
+
+using std::min;
+using std::max;
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+
+// GPIO interrupts fire from delay() at the scripted press edges, with the
+// clock set to the edge time
+#define digitalPinToInterrupt(p) (p)
+void attachInterrupt(uint8_t pin, void (*isr)(), int mode);
+void detachInterrupt(uint8_t pin);
+
+// ADC: BAT_ADC_PIN reads half the simulated battery voltage (the board's
+// 100K/100K divider); every other pin reads 0
+typedef enum { ADC_0db = 0, ADC_2_5db, ADC_6db, ADC_11db } adc_attenuation_t;
+void analogReadResolution(uint8_t bits);
+void analogSetPinAttenuation(uint8_t pin, adc_attenuation_t atten);
+uint16_t analogRead(uint8_t pin);
+
+// CPU clock (recorded only; virtual time does not scale with it)
+bool setCpuFrequencyMhz(uint32_t mhz);
+uint32_t getCpuFrequencyMhz();
+
+// PSRAM (the simulator has plenty unless run with --no-psram; ps_*
+// allocate from the host heap)
+bool psramFound();
+void* ps_malloc(size_t size);
+void* ps_calloc(size_t n, size_t size);
+
+class HardwareSerial {
+public:
+  void begin(unsigned long baud);
+  void flush() {}
+  size_t print(const char* s);
+  size_t print(int v);
+  size_t println(const char* s = "");
+  size_t println(int v);
+  size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+};
+
+extern HardwareSerial Serial;
@@ -0,0 +1,196 @@
+#include <FS.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace fs {
+
+struct FileImpl {
+  std::string vpath;   // path as seen by the firmware
+  std::string host;    // backing path on the host
+  FILE* fp = nullptr;
+  DIR* dir = nullptr;
+  FS::IoHook io = nullptr;
+
+  ~FileImpl() {
+    if (fp) fclose(fp);
+    if (dir) closedir(dir);
+  }
+};
+
+static bool hostIsDir(const std::string& p) {
+  struct stat st;
+  return stat(p.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+static void makeParents(const std::string& p) {
+  for (size_t i = 1; i < p.size(); i++) {
+    if (p[i] == '/') ::mkdir(p.substr(0, i).c_str(), 0755);
+  }
+}
+
+// --- File ---
+
+size_t File::write(uint8_t c) { return write(&c, 1); }
+
+size_t File::write(const uint8_t* buf, size_t size) {
+  if (!_p || !_p->fp) return 0;
+  size_t n = fwrite(buf, 1, size, _p->fp);
+  if (_p->io) _p->io((uint8_t*)buf, n, true);
+  return n;
+}
+
+int File::available() {
+  if (!_p || !_p->fp) return 0;
+  long pos = ftell(_p->fp);
+  return (int)(size() - (size_t)pos);
+}
+
+int File::read() {
+  uint8_t c;
+  return read(&c, 1) == 1 ? c : -1;
+}
+
+size_t File::read(uint8_t* buf, size_t size) {
+  if (!_p || !_p->fp) return 0;
+  size_t n = fread(buf, 1, size, _p->fp);
+  if (_p->io) _p->io(buf, n, false);
+  return n;
+}
+
+int File::peek() {
+  if (!_p || !_p->fp) return -1;
+  int c = fgetc(_p->fp);
+  if (c != EOF) ungetc(c, _p->fp);
+  return c == EOF ? -1 : c;
+}
+
+void File::flush() {
+  if (_p && _p->fp) fflush(_p->fp);
+}
+
+bool File::seek(uint32_t pos, SeekMode mode) {
+  if (!_p || !_p->fp) return false;
+  int whence = mode == SeekCur ? SEEK_CUR : mode == SeekEnd ? SEEK_END : SEEK_SET;
+  return fseek(_p->fp, (long)pos, whence) == 0;
+}
+
+size_t File::position() const {
+  if (!_p || !_p->fp) return 0;
+  return (size_t)ftell(_p->fp);
+}
+
+size_t File::size() const {
+  if (!_p) return 0;
+  if (_p->fp) fflush(_p->fp);
+  struct stat st;
+  if (stat(_p->host.c_str(), &st) != 0) return 0;
+  return (size_t)st.st_size;
+}
+
+void File::close() { _p.reset(); }
+
+File::operator bool() const { return _p && (_p->fp || _p->dir); }
+
+const char* File::path() const { return _p ? _p->vpath.c_str() : ""; }
+
+const char* File::name() const {
+  if (!_p) return "";
+  const char* slash = strrchr(_p->vpath.c_str(), '/');
+  return slash ? slash + 1 : _p->vpath.c_str();
+}
+
+bool File::isDirectory() const { return _p && _p->dir; }
+
+File File::openNextFile(const char* mode) {
+  (void)mode;
+  if (!_p || !_p->dir) return File();
+  struct dirent* e;
+  while ((e = readdir(_p->dir)) != nullptr) {
+    if (strcmp(e->d_name, ".") == 0 || strcmp(e->d_name, "..") == 0) continue;
+    auto impl = std::make_shared<FileImpl>();
+    impl->vpath = _p->vpath == "/" ? "/" + std::string(e->d_name)
+                                   : _p->vpath + "/" + e->d_name;
+    impl->host = _p->host + "/" + e->d_name;
+    impl->io = _p->io;
+    if (hostIsDir(impl->host)) {
+      impl->dir = opendir(impl->host.c_str());
+    } else {
+      impl->fp = fopen(impl->host.c_str(), "rb");
+    }
+    if (impl->fp || impl->dir) return File(impl);
+  }
+  return File();
+}
+
+void File::rewindDirectory() {
+  if (_p && _p->dir) rewinddir(_p->dir);
+}
+
+// --- FS ---
+
+std::string FS::hostPath(const char* path) const {
+  std::string p = path ? path : "/";
+  if (p.empty() || p[0] != '/') p = "/" + p;
+  if (p.size() > 1 && p.back() == '/') p.pop_back();
+  return _root() + (p == "/" ? "" : p);
+}
+
+File FS::open(const char* path, const char* mode, const bool create) {
+  std::string host = hostPath(path);
+  auto impl = std::make_shared<FileImpl>();
+  impl->vpath = path;
+  impl->host = host;
+  impl->io = _io;
+
+  if (mode[0] == 'r' && hostIsDir(host)) {
+    impl->dir = opendir(host.c_str());
+    return impl->dir ? File(impl) : File();
+  }
+
+  if (mode[0] != 'r' && create) makeParents(host);
+  const char* hostMode = mode[0] == 'w' ? "wb" : mode[0] == 'a' ? "ab" : "rb";
+  if (mode[0] == 'r' && mode[1] == '+') hostMode = "r+b";
+  impl->fp = fopen(host.c_str(), hostMode);
+  return impl->fp ? File(impl) : File();
+}
+
+bool FS::exists(const char* path) {
+  struct stat st;
+  return stat(hostPath(path).c_str(), &st) == 0;
+}
+
+bool FS::remove(const char* path) { return unlink(hostPath(path).c_str()) == 0; }
+
+bool FS::rename(const char* from, const char* to) {
+  return ::rename(hostPath(from).c_str(), hostPath(to).c_str()) == 0;
+}
+
+bool FS::mkdir(const char* path) {
+  std::string host = hostPath(path);
+  return ::mkdir(host.c_str(), 0755) == 0 || hostIsDir(host);
+}
+
+bool FS::rmdir(const char* path) { return ::rmdir(hostPath(path).c_str()) == 0; }
+
+// Sum of file sizes, rounded up to 4 KB blocks like LittleFS allocates them
+static uint64_t usedBelow(const std::string& dir) {
+  uint64_t used = 0;
+  DIR* d = opendir(dir.c_str());
+  if (!d) return 0;
+  struct dirent* e;
+  while ((e = readdir(d)) != nullptr) {
+    if (strcmp(e->d_name, ".") == 0 || strcmp(e->d_name, "..") == 0) continue;
+    std::string p = dir + "/" + e->d_name;
+    struct stat st;
+    if (stat(p.c_str(), &st) != 0) continue;
+    if (S_ISDIR(st.st_mode)) used += 4096 + usedBelow(p);
+    else used += ((uint64_t)st.st_size + 4095) / 4096 * 4096;
+  }
+  closedir(d);
+  return used;
+}
+
+uint64_t FS::hostUsedBytes() const { return usedBelow(_root()); }
+
+} // namespace fs
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <Arduino.h>
+#include <memory>
+#include <string>
+
+// ============================================================
+// Host stand-in for the Arduino-ESP32 fs::FS / fs::File API.
+// Paths are mapped below a host directory chosen by the runner.
+// ============================================================
+
+#define FILE_READ   "r"
+#define FILE_WRITE  "w"
+#define FILE_APPEND "a"
+
+namespace fs {
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+struct FileImpl;
+
+class File {
+public:
+  File() {}
+  explicit File(std::shared_ptr<FileImpl> impl) : _p(impl) {}
+
+  size_t write(uint8_t c);
+  size_t write(const uint8_t* buf, size_t size);
+  int available();
+  int read();
+  size_t read(uint8_t* buf, size_t size);
+  size_t readBytes(char* buf, size_t size) { return read((uint8_t*)buf, size); }
+  int peek();
+  void flush();
+  bool seek(uint32_t pos, SeekMode mode = SeekSet);
+  size_t position() const;
+  size_t size() const;
+  void close();
+  operator bool() const;
+  const char* path() const;
+  const char* name() const;
+  bool isDirectory() const;
+  File openNextFile(const char* mode = FILE_READ);
+  void rewindDirectory();
+
+private:
+  std::shared_ptr<FileImpl> _p;
+};
+
+class FS {
+public:
+  // Called with every block read from or written to a file (the SD card
+  // models bus time and clock errors here); nullptr for none
+  typedef void (*IoHook)(uint8_t* buf, size_t size, bool write);
+
+  // root: returns the host directory this filesystem is mounted on
+  explicit FS(const std::string& (*root)(), IoHook io = nullptr) : _root(root), _io(io) {}
+
+  File open(const char* path, const char* mode = FILE_READ, const bool create = false);
+  bool exists(const char* path);
+  bool remove(const char* path);
+  bool rename(const char* from, const char* to);
+  bool mkdir(const char* path);
+  bool rmdir(const char* path);
+
+protected:
+  std::string hostPath(const char* path) const;
+  uint64_t hostUsedBytes() const;
+
+private:
+  const std::string& (*_root)();
+  IoHook _io;
+};
+
+} // namespace fs
+
+using fs::FS;
+using fs::File;
+using fs::SeekMode;
+using fs::SeekSet;
+using fs::SeekCur;
+using fs::SeekEnd;
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <FS.h>
+#include "sim.h"
+
+// Host stand-in for LittleFS, backed by simFsRoot()
+class LittleFSFS : public fs::FS {
+public:
+  LittleFSFS() : fs::FS(simFsRoot) {}
+
+  bool begin(bool formatOnFail = false, const char* basePath = "/littlefs",
+             uint8_t maxOpenFiles = 10, const char* partitionLabel = "spiffs");
+  void end() {}
+  size_t totalBytes() { return 1920 * 1024; }  // no_ota.csv data partition
+  size_t usedBytes() { return (size_t)hostUsedBytes(); }
+};
+
+extern LittleFSFS LittleFS;
@@ -0,0 +1,70 @@
+#include <Preferences.h>
+#include <map>
+#include <mutex>
+
+static std::map<std::string, int64_t> store;  // "namespace/key" -> value
+static uint32_t nvsWrites = 0;
+static std::mutex storeMu;   // NVS is shared by every task
+
+uint32_t simNvsWrites() { return nvsWrites; }
+
+bool Preferences::begin(const char* name, bool readOnly, const char*) {
+  _ns = name;
+  _open = true;
+  _readOnly = readOnly;
+  return true;
+}
+
+void Preferences::end() { _open = false; }
+
+int32_t Preferences::getInt(const char* key, int32_t defaultValue) {
+  std::lock_guard<std::mutex> lk(storeMu);
+  auto it = store.find(_ns + "/" + key);
+  return (_open && it != store.end()) ? (int32_t)it->second : defaultValue;
+}
+
+size_t Preferences::putInt(const char* key, int32_t value) {
+  std::lock_guard<std::mutex> lk(storeMu);
+  if (!_open || _readOnly) return 0;
+  store[_ns + "/" + key] = value;
+  nvsWrites++;
+  return sizeof(value);
+}
+
+uint32_t Preferences::getUInt(const char* key, uint32_t defaultValue) {
+  std::lock_guard<std::mutex> lk(storeMu);
+  auto it = store.find(_ns + "/" + key);
+  return (_open && it != store.end()) ? (uint32_t)it->second : defaultValue;
+}
+
+size_t Preferences::putUInt(const char* key, uint32_t value) {
+  std::lock_guard<std::mutex> lk(storeMu);
+  if (!_open || _readOnly) return 0;
+  store[_ns + "/" + key] = value;
+  nvsWrites++;
+  return sizeof(value);
+}
+
+bool Preferences::isKey(const char* key) {
+  std::lock_guard<std::mutex> lk(storeMu);
+  return _open && store.count(_ns + "/" + key) != 0;
+}
+
+bool Preferences::remove(const char* key) {
+  std::lock_guard<std::mutex> lk(storeMu);
+  if (!_open || _readOnly) return false;
+  nvsWrites++;
+  return store.erase(_ns + "/" + key) != 0;
+}
+
+bool Preferences::clear() {
+  std::lock_guard<std::mutex> lk(storeMu);
+  if (!_open || _readOnly) return false;
+  std::string prefix = _ns + "/";
+  for (auto it = store.begin(); it != store.end();) {
+    if (it->first.compare(0, prefix.size(), prefix) == 0) it = store.erase(it);
+    else ++it;
+  }
+  nvsWrites++;
+  return true;
+}
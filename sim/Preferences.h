@@ -0,0 +1,29 @@
+#pragma once
+
+#include <Arduino.h>
+#include <string>
+
+// Host stand-in for the ESP32 NVS Preferences API. Values live in a
+// process-wide map (safe to use from any task); every put is counted as
+// one NVS commit.
+class Preferences {
+public:
+  bool begin(const char* name, bool readOnly = false, const char* partitionLabel = nullptr);
+  void end();
+
+  int32_t getInt(const char* key, int32_t defaultValue = 0);
+  size_t putInt(const char* key, int32_t value);
+  uint32_t getUInt(const char* key, uint32_t defaultValue = 0);
+  size_t putUInt(const char* key, uint32_t value);
+  bool isKey(const char* key);
+  bool remove(const char* key);
+  bool clear();
+
+private:
+  std::string _ns;
+  bool _open = false;
+  bool _readOnly = false;
+};
+
+// Number of NVS writes since boot
+uint32_t simNvsWrites();
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <FS.h>
+#include <SPI.h>
+#include "sim.h"
+
+typedef enum {
+  CARD_NONE,
+  CARD_MMC,
+  CARD_SD,
+  CARD_SDHC,
+  CARD_UNKNOWN
+} sdcard_type_t;
+
+// Host stand-in for the ESP32 SD library, backed by simSdRoot().
+// With no SD root configured the card is reported as absent.  File
+// transfers take bus time on the virtual clock at the mounted frequency,
+// and above simSdMaxHz() they come back with flipped bits.
+class SDFS : public fs::FS {
+public:
+  SDFS();
+
+  bool begin(uint8_t ssPin, SPIClass& spi, uint32_t frequency = 4000000,
+             const char* mountpoint = "/sd", uint8_t maxFiles = 5,
+             bool formatIfEmpty = false);
+  void end();
+  sdcard_type_t cardType() { return _mounted ? CARD_SDHC : CARD_NONE; }
+  uint64_t cardSize() { return _mounted ? 8ULL * 1024 * 1024 * 1024 : 0; }
+  uint64_t totalBytes() { return cardSize(); }
+  uint64_t usedBytes() { return _mounted ? hostUsedBytes() : 0; }
+  size_t numSectors() { return (size_t)(cardSize() / 512); }
+  // Sectors hold a fixed pattern per SD root and sector, so another root
+  // reads as another card.  Timed and corrupted like file reads.
+  bool readRAW(uint8_t* buffer, uint32_t sector);
+
+private:
+  bool _mounted = false;
+};
+
+extern SDFS SD;
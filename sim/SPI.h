@@ -0,0 +1,22 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Host stand-in for the ESP32 SPIClass. The bus itself is modelled by
+// the TFT_eSPI stand-in's byte counters; this only tracks pin setup.
+class SPIClass {
+public:
+  void begin(int8_t sck = -1, int8_t miso = -1, int8_t mosi = -1, int8_t ss = -1) {
+    (void)sck; (void)mosi; (void)ss;
+    _miso = miso;
+    _initted = true;
+  }
+  void end() { _initted = false; }
+  void setFrequency(uint32_t freq) { _freq = freq; }
+  uint32_t getFrequency() const { return _freq; }
+
+private:
+  bool _initted = false;
+  int8_t _miso = -1;
+  uint32_t _freq = 1000000;
+};
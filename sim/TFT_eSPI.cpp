@@ -0,0 +1,326 @@
+#include <TFT_eSPI.h>
+#include <vector>
+#include "glcdfont.h"
+
+// Address window overhead: CASET(1+4) + RASET(1+4) + RAMWR(1)
+#define WINDOW_BYTES 11
+
+static inline uint16_t bswap16(uint16_t v) { return (v >> 8) | (v << 8); }
+
+static void countWindow(uint32_t pixels) {
+  SimFrameStats& s = simFrame();
+  s.windows++;
+  s.pixels += pixels;
+  s.bytes += WINDOW_BYTES + pixels * 2;
+}
+
+// Glyph scaling per font number: x/y scale, advance and cell height
+struct SimFont {
+  uint8_t sx, sy, advance, height, yoff;
+};
+
+static SimFont fontFor(uint8_t font) {
+  switch (font) {
+    case 2:  return {1, 2, 7, 16, 1};
+    case 4:  return {2, 3, 13, 26, 2};
+    case 6:  return {4, 6, 23, 48, 3};
+    case 7:  return {4, 6, 23, 48, 3};
+    case 8:  return {6, 10, 35, 75, 2};
+    default: return {1, 1, 6, 8, 0};
+  }
+}
+
+// --- TFT_eSPI (panel) ---
+
+TFT_eSPI::TFT_eSPI(int16_t w, int16_t h) : _width(w), _height(h) {}
+
+void TFT_eSPI::init(uint8_t) {
+  memset(simFramebuffer(), 0, SIM_W * SIM_H * sizeof(uint16_t));
+}
+
+bool TFT_eSPI::clip(int32_t& x, int32_t& y, int32_t& w, int32_t& h) const {
+  if (x < 0) { w += x; x = 0; }
+  if (y < 0) { h += y; y = 0; }
+  if (x + w > _width) w = _width - x;
+  if (y + h > _height) h = _height - y;
+  return w > 0 && h > 0;
+}
+
+void TFT_eSPI::drawPixel(int32_t x, int32_t y, uint32_t color) {
+  if (x < 0 || y < 0 || x >= _width || y >= _height) return;
+  simFramebuffer()[y * SIM_W + x] = (uint16_t)color;
+  countWindow(1);
+}
+
+void TFT_eSPI::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+  if (!clip(x, y, w, h)) return;
+  uint16_t* fb = simFramebuffer();
+  for (int32_t row = y; row < y + h; row++) {
+    for (int32_t col = x; col < x + w; col++) fb[row * SIM_W + col] = (uint16_t)color;
+  }
+  countWindow((uint32_t)(w * h));
+}
+
+void TFT_eSPI::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data) {
+  int32_t cx = x, cy = y, cw = w, ch = h;
+  if (!clip(cx, cy, cw, ch)) return;
+  uint16_t* fb = simFramebuffer();
+  for (int32_t row = cy; row < cy + ch; row++) {
+    const uint16_t* src = data + (row - y) * w + (cx - x);
+    for (int32_t col = 0; col < cw; col++) {
+      // Without swapBytes the buffer already holds SPI byte order
+      fb[row * SIM_W + cx + col] = _swapBytes ? src[col] : bswap16(src[col]);
+    }
+  }
+  countWindow((uint32_t)(cw * ch));
+}
+
+void TFT_eSPI::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint8_t* data, bool bpp8) {
+  (void)bpp8;
+  int32_t cx = x, cy = y, cw = w, ch = h;
+  if (!clip(cx, cy, cw, ch)) return;
+  uint16_t* fb = simFramebuffer();
+  for (int32_t row = cy; row < cy + ch; row++) {
+    const uint8_t* src = data + (row - y) * w + (cx - x);
+    for (int32_t col = 0; col < cw; col++) fb[row * SIM_W + cx + col] = color8to16(src[col]);
+  }
+  countWindow((uint32_t)(cw * ch));
+}
+
+void TFT_eSPI::pushImageDMA(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t* data, uint16_t* buffer) {
+  (void)buffer;
+  if (!_dma) return;   // as on hardware, nothing goes out before initDMA()
+  pushImage(x, y, w, h, data);
+  simFrame().dmaTransfers++;
+}
+
+uint16_t TFT_eSPI::color8to16(uint8_t color) {
+  static const uint8_t blue[] = {0, 11, 21, 31};
+  uint16_t color16 = (color & 0x1C) << 6 | (color & 0xC0) << 5 | (color & 0xE0) << 8;
+  color16 |= (color & 0x1C) << 3 | blue[color & 0x03];
+  return color16;
+}
+
+void TFT_eSPI::drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color) {
+  fillRect(x, y, w, 1, color);
+}
+
+void TFT_eSPI::drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color) {
+  fillRect(x, y, 1, h, color);
+}
+
+void TFT_eSPI::fillScreen(uint32_t color) { fillRect(0, 0, _width, _height, color); }
+
+void TFT_eSPI::drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+  drawFastHLine(x, y, w, color);
+  drawFastHLine(x, y + h - 1, w, color);
+  drawFastVLine(x, y + 1, h - 2, color);
+  drawFastVLine(x + w - 1, y + 1, h - 2, color);
+}
+
+void TFT_eSPI::drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color) {
+  int32_t dx = abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+  int32_t dy = -abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+  int32_t err = dx + dy;
+  while (true) {
+    drawPixel(x0, y0, color);
+    if (x0 == x1 && y0 == y1) break;
+    int32_t e2 = 2 * err;
+    if (e2 >= dy) { err += dy; x0 += sx; }
+    if (e2 <= dx) { err += dx; y0 += sy; }
+  }
+}
+
+void TFT_eSPI::drawCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color) {
+  int32_t f = 1 - r, ddx = 1, ddy = -2 * r, x = 0, y = r;
+  drawPixel(x0, y0 + r, color);
+  drawPixel(x0, y0 - r, color);
+  drawPixel(x0 + r, y0, color);
+  drawPixel(x0 - r, y0, color);
+  while (x < y) {
+    if (f >= 0) { y--; ddy += 2; f += ddy; }
+    x++; ddx += 2; f += ddx;
+    drawPixel(x0 + x, y0 + y, color); drawPixel(x0 - x, y0 + y, color);
+    drawPixel(x0 + x, y0 - y, color); drawPixel(x0 - x, y0 - y, color);
+    drawPixel(x0 + y, y0 + x, color); drawPixel(x0 - y, y0 + x, color);
+    drawPixel(x0 + y, y0 - x, color); drawPixel(x0 - y, y0 - x, color);
+  }
+}
+
+void TFT_eSPI::fillCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color) {
+  for (int32_t dy = -r; dy <= r; dy++) {
+    int32_t dx = (int32_t)sqrtf((float)(r * r - dy * dy));
+    drawFastHLine(x0 - dx, y0 + dy, 2 * dx + 1, color);
+  }
+}
+
+void TFT_eSPI::fillTriangle(int32_t x0, int32_t y0, int32_t x1, int32_t y1,
+                            int32_t x2, int32_t y2, uint32_t color) {
+  int32_t minY = std::min(y0, std::min(y1, y2));
+  int32_t maxY = std::max(y0, std::max(y1, y2));
+  const int32_t xs[3] = {x0, x1, x2}, ys[3] = {y0, y1, y2};
+  for (int32_t y = minY; y <= maxY; y++) {
+    int32_t lo = INT32_MAX, hi = INT32_MIN;
+    for (int e = 0; e < 3; e++) {
+      int32_t ax = xs[e], ay = ys[e], bx = xs[(e + 1) % 3], by = ys[(e + 1) % 3];
+      if ((y < ay && y < by) || (y > ay && y > by)) continue;
+      if (ay == by) {
+        lo = std::min(lo, std::min(ax, bx));
+        hi = std::max(hi, std::max(ax, bx));
+        continue;
+      }
+      int32_t x = ax + (bx - ax) * (y - ay) / (by - ay);
+      lo = std::min(lo, x);
+      hi = std::max(hi, x);
+    }
+    if (lo <= hi) drawFastHLine(lo, y, hi - lo + 1, color);
+  }
+}
+
+// --- Text ---
+
+int16_t TFT_eSPI::textWidth(const char* s, uint8_t font) {
+  return (int16_t)(strlen(s) * fontFor(font).advance);
+}
+
+int16_t TFT_eSPI::textWidth(const char* s) { return textWidth(s, _textFont); }
+
+int16_t TFT_eSPI::fontHeight(int16_t font) { return fontFor((uint8_t)font).height; }
+
+int16_t TFT_eSPI::drawString(const char* s, int32_t x, int32_t y) {
+  return drawString(s, x, y, _textFont);
+}
+
+int16_t TFT_eSPI::drawString(const char* s, int32_t x, int32_t y, uint8_t font) {
+  SimFont f = fontFor(font);
+  int16_t w = textWidth(s, font);
+
+  switch (_textDatum % 3) {
+    case 1: x -= w / 2; break;
+    case 2: x -= w; break;
+  }
+  switch (_textDatum / 3) {
+    case 1: y -= f.height / 2; break;
+    case 2: y -= f.height; break;
+  }
+
+  // A distinct background colour fills the whole text cell, as the
+  // real RLE fonts do; otherwise glyph pixels are drawn in row runs.
+  if (_textBg != _textFg) fillRect(x, y, w, f.height, _textBg);
+
+  for (const char* p = s; *p; p++, x += f.advance) {
+    unsigned char c = (unsigned char)*p;
+    if (c < 0x20 || c > 0x7E) c = '?';
+    const uint8_t* g = simGlyphs[c - 0x20];
+    for (int gy = 0; gy < 7; gy++) {
+      int gx = 0;
+      while (gx < 5) {
+        if (!(g[gx] & (1 << gy))) { gx++; continue; }
+        int run = gx;
+        while (run < 5 && (g[run] & (1 << gy))) run++;
+        fillRect(x + gx * f.sx, y + f.yoff + gy * f.sy, (run - gx) * f.sx, f.sy, _textFg);
+        gx = run;
+      }
+    }
+  }
+  return w;
+}
+
+// --- TFT_eSprite ---
+
+TFT_eSprite::TFT_eSprite(TFT_eSPI* tft) : TFT_eSPI(0, 0), _tft(tft) {}
+
+void* TFT_eSprite::createSprite(int16_t w, int16_t h, uint8_t frames) {
+  (void)frames;
+  if (_img) return _img;
+  size_t bytes = (size_t)w * h * _bpp / 8;
+  _img = (uint8_t*)calloc(bytes ? bytes : 1, 1);
+  if (!_img) return nullptr;
+  _width = w;
+  _height = h;
+  return _img;
+}
+
+void TFT_eSprite::deleteSprite() {
+  free(_img);
+  _img = nullptr;
+  _width = _height = 0;
+}
+
+void* TFT_eSprite::setColorDepth(int8_t b) {
+  int16_t w = _width, h = _height;
+  bool had = created();
+  if (had) deleteSprite();
+  _bpp = (b == 4 || b == 8 || b == 16) ? b : 16;
+  return had ? createSprite(w, h) : nullptr;
+}
+
+void TFT_eSprite::drawPixel(int32_t x, int32_t y, uint32_t color) {
+  fillRect(x, y, 1, 1, color);
+}
+
+void TFT_eSprite::fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) {
+  if (!_img || !clip(x, y, w, h)) return;
+  if (_bpp == 16) {
+    uint16_t c = bswap16((uint16_t)color);
+    uint16_t* img = (uint16_t*)_img;
+    for (int32_t row = y; row < y + h; row++) {
+      for (int32_t col = x; col < x + w; col++) img[row * _width + col] = c;
+    }
+  } else if (_bpp == 8) {
+    uint8_t c = (uint8_t)(((color & 0xE000) >> 8) | ((color & 0x0700) >> 6) | ((color & 0x0018) >> 3));
+    for (int32_t row = y; row < y + h; row++) memset(_img + row * _width + x, c, w);
+  } else {
+    // Two pixels per byte, even X in the high nibble
+    uint8_t c = color & 0x0F;
+    for (int32_t row = y; row < y + h; row++) {
+      uint8_t* r = _img + row * (_width >> 1);
+      int32_t col = x, end = x + w;
+      if (col & 1) { r[col >> 1] = (r[col >> 1] & 0xF0) | c; col++; }
+      if (end & 1) { r[end >> 1] = (r[end >> 1] & 0x0F) | (c << 4); end--; }
+      if (end > col) memset(r + (col >> 1), c * 0x11, (end - col) >> 1);
+    }
+  }
+}
+
+void TFT_eSprite::createPalette(const uint16_t* palette, uint8_t colors) {
+  for (int i = 0; i < 16; i++) _palette[i] = (palette && i < colors) ? palette[i] : 0;
+}
+
+void TFT_eSprite::pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data) {
+  for (int32_t row = 0; row < h; row++) {
+    for (int32_t col = 0; col < w; col++) {
+      uint16_t c = data[row * w + col];
+      drawPixel(x + col, y + row, _swapBytes ? c : bswap16(c));
+    }
+  }
+}
+
+uint16_t TFT_eSprite::readPixel(int32_t x, int32_t y) {
+  if (!_img || x < 0 || y < 0 || x >= _width || y >= _height) return 0;
+  if (_bpp == 16) return bswap16(((uint16_t*)_img)[y * _width + x]);
+  if (_bpp == 4) return _palette[(_img[(y * _width + x) >> 1] >> ((~x & 1) << 2)) & 0x0F];
+  return color8to16(_img[y * _width + x]);
+}
+
+void TFT_eSprite::pushSprite(int32_t x, int32_t y) {
+  if (!_img) return;
+  if (_bpp == 16) {
+    bool swap = _tft->getSwapBytes();
+    _tft->setSwapBytes(false);
+    _tft->pushImage(x, y, _width, _height, (const uint16_t*)_img);
+    _tft->setSwapBytes(swap);
+  } else if (_bpp == 8) {
+    _tft->pushImage(x, y, _width, _height, _img, true);
+  } else {
+    // Expanded through the palette, sent as one window like the real 4-bit path
+    std::vector<uint16_t> px((size_t)_width * _height);
+    for (int32_t row = 0; row < _height; row++) {
+      for (int32_t col = 0; col < _width; col++) px[row * _width + col] = readPixel(col, row);
+    }
+    bool swap = _tft->getSwapBytes();
+    _tft->setSwapBytes(true);
+    _tft->pushImage(x, y, _width, _height, px.data());
+    _tft->setSwapBytes(swap);
+  }
+}
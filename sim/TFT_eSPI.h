@@ -0,0 +1,157 @@
+#pragma once
+
+#include <Arduino.h>
+#include <SPI.h>
+#include "sim.h"
+
+// ============================================================
+// Host stand-in for TFT_eSPI / TFT_eSprite (native simulator build)
+// The panel draws into simFramebuffer() and counts every address
+// window and pixel it would have sent. Text uses a scaled 5x7 glyph
+// set with metrics close to the real fonts 1/2/4/6/7/8.
+// ============================================================
+
+#define TFT_BLACK       0x0000
+#define TFT_NAVY        0x000F
+#define TFT_DARKGREEN   0x03E0
+#define TFT_DARKCYAN    0x03EF
+#define TFT_MAROON      0x7800
+#define TFT_PURPLE      0x780F
+#define TFT_OLIVE       0x7BE0
+#define TFT_LIGHTGREY   0xD69A
+#define TFT_DARKGREY    0x7BEF
+#define TFT_BLUE        0x001F
+#define TFT_GREEN       0x07E0
+#define TFT_CYAN        0x07FF
+#define TFT_RED         0xF800
+#define TFT_MAGENTA     0xF81F
+#define TFT_YELLOW      0xFFE0
+#define TFT_WHITE       0xFFFF
+#define TFT_ORANGE      0xFDA0
+#define TFT_GREENYELLOW 0xB7E0
+#define TFT_PINK        0xFE19
+#define TFT_BROWN       0x9A60
+#define TFT_GOLD        0xFEA0
+#define TFT_SILVER      0xC618
+#define TFT_SKYBLUE     0x867D
+#define TFT_VIOLET      0x915C
+
+#define TL_DATUM 0
+#define TC_DATUM 1
+#define TR_DATUM 2
+#define ML_DATUM 3
+#define CL_DATUM 3
+#define MC_DATUM 4
+#define CC_DATUM 4
+#define MR_DATUM 5
+#define CR_DATUM 5
+#define BL_DATUM 6
+#define BC_DATUM 7
+#define BR_DATUM 8
+
+class TFT_eSPI {
+public:
+  TFT_eSPI(int16_t w = TFT_WIDTH, int16_t h = TFT_HEIGHT);
+  virtual ~TFT_eSPI() {}
+
+  void init(uint8_t tc = 0);
+  void setRotation(uint8_t r) { _rotation = r; }
+  int16_t width() const { return _width; }
+  int16_t height() const { return _height; }
+
+  void startWrite() {}
+  void endWrite() {}
+  void setSwapBytes(bool swap) { _swapBytes = swap; }
+  bool getSwapBytes() const { return _swapBytes; }
+  SPIClass& getSPIinstance() { return _spi; }
+
+  // --- Graphics primitives ---
+  virtual void drawPixel(int32_t x, int32_t y, uint32_t color);
+  virtual void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+  void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t color);
+  void drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t color);
+  void fillScreen(uint32_t color);
+  void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color);
+  void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t color);
+  void drawCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color);
+  void fillCircle(int32_t x0, int32_t y0, int32_t r, uint32_t color);
+  void fillTriangle(int32_t x0, int32_t y0, int32_t x1, int32_t y1,
+                    int32_t x2, int32_t y2, uint32_t color);
+
+  // --- Text ---
+  void setTextColor(uint16_t c) { _textFg = c; _textBg = c; }
+  void setTextColor(uint16_t fg, uint16_t bg, bool bgfill = false) {
+    (void)bgfill;
+    _textFg = fg;
+    _textBg = bg;
+  }
+  void setTextDatum(uint8_t d) { _textDatum = d; }
+  void setTextFont(uint8_t f) { _textFont = f; }
+  int16_t drawString(const char* s, int32_t x, int32_t y);
+  int16_t drawString(const char* s, int32_t x, int32_t y, uint8_t font);
+  int16_t textWidth(const char* s);
+  int16_t textWidth(const char* s, uint8_t font);
+  int16_t fontHeight(int16_t font);
+  int16_t fontHeight() { return fontHeight(_textFont); }
+
+  // --- Images ---
+  virtual void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data);
+  void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint8_t* data, bool bpp8 = true);
+
+  // --- DMA ---
+  // Transfers complete immediately; traffic is counted like pushImage
+  bool initDMA(bool ctrl_cs = false) { (void)ctrl_cs; _dma = true; return true; }
+  void deInitDMA() { _dma = false; }
+  void pushImageDMA(int32_t x, int32_t y, int32_t w, int32_t h, uint16_t* data, uint16_t* buffer = nullptr);
+  bool dmaBusy() { return false; }
+  void dmaWait() {}
+
+  uint16_t color565(uint8_t r, uint8_t g, uint8_t b) {
+    return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+  }
+  uint16_t color8to16(uint8_t color);
+
+protected:
+  int16_t _width, _height;
+  uint8_t _rotation = 0;
+  bool _swapBytes = false;
+  bool _dma = false;
+  uint16_t _textFg = TFT_WHITE, _textBg = TFT_WHITE;
+  uint8_t _textDatum = TL_DATUM;
+  uint8_t _textFont = 1;
+  SPIClass _spi;
+
+  // Clip a rectangle to the drawable area; false if nothing is left
+  bool clip(int32_t& x, int32_t& y, int32_t& w, int32_t& h) const;
+};
+
+class TFT_eSprite : public TFT_eSPI {
+public:
+  explicit TFT_eSprite(TFT_eSPI* tft);
+  ~TFT_eSprite() override { deleteSprite(); }
+
+  void* createSprite(int16_t w, int16_t h, uint8_t frames = 1);
+  void deleteSprite();
+  bool created() const { return _img != nullptr; }
+  void* setColorDepth(int8_t b);
+  int8_t getColorDepth() const { return _bpp; }
+  void* getPointer() { return _img; }
+
+  // 4-bit sprites draw with palette indices 0..15
+  void createPalette(const uint16_t* palette, uint8_t colors = 16);
+
+  void fillSprite(uint32_t color) { fillRect(0, 0, _width, _height, color); }
+  uint16_t readPixel(int32_t x, int32_t y);
+  void pushSprite(int32_t x, int32_t y);
+
+  using TFT_eSPI::pushImage;
+  void drawPixel(int32_t x, int32_t y, uint32_t color) override;
+  void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t color) override;
+  void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t* data) override;
+
+private:
+  TFT_eSPI* _tft;
+  uint8_t* _img = nullptr;
+  int8_t _bpp = 16;
+  uint16_t _palette[16] = {};
+};
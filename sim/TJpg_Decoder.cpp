@@ -0,0 +1,89 @@
+#include <TJpg_Decoder.h>
+#include <vector>
+
+TJpg_Decoder TJpgDec;
+
+static bool readAll(fs::FS& fs, const char* path, std::vector<uint8_t>& out) {
+  File f = fs.open(path, FILE_READ);
+  if (!f) return false;
+  out.resize(f.size());
+  size_t n = out.empty() ? 0 : f.read(out.data(), out.size());
+  f.close();
+  return n == out.size();
+}
+
+JRESULT TJpg_Decoder::getFsJpgSize(uint16_t* w, uint16_t* h, const char* path, fs::FS& fs) {
+  std::vector<uint8_t> buf;
+  *w = *h = 0;
+  if (!readAll(fs, path, buf)) return JDR_INP;
+  return decode(0, 0, buf.data(), buf.size(), false, w, h);
+}
+
+JRESULT TJpg_Decoder::drawFsJpg(int32_t x, int32_t y, const char* path, fs::FS& fs) {
+  std::vector<uint8_t> buf;
+  if (!readAll(fs, path, buf)) return JDR_INP;
+  uint16_t w, h;
+  return decode(x, y, buf.data(), buf.size(), true, &w, &h);
+}
+
+JRESULT TJpg_Decoder::getJpgSize(uint16_t* w, uint16_t* h, const uint8_t* data, uint32_t size) {
+  *w = *h = 0;
+  return decode(0, 0, data, size, false, w, h);
+}
+
+JRESULT TJpg_Decoder::drawJpg(int32_t x, int32_t y, const uint8_t* data, uint32_t size) {
+  uint16_t w, h;
+  return decode(x, y, data, size, true, &w, &h);
+}
+
+JRESULT TJpg_Decoder::decode(int32_t x, int32_t y, const uint8_t* d, uint32_t size, bool draw,
+                             uint16_t* w, uint16_t* h) {
+  if (size < 4 || d[0] != 0xFF || d[1] != 0xD8) return JDR_FMT1;
+
+  // Walk marker segments to the first SOFn
+  uint32_t pos = 2, hash = 2166136261u;
+  int mcuW = 8, mcuH = 8;
+  *w = *h = 0;
+  while (pos + 4 <= size) {
+    if (d[pos] != 0xFF) return JDR_FMT1;
+    uint8_t marker = d[pos + 1];
+    uint32_t len = (d[pos + 2] << 8) | d[pos + 3];
+    if (marker >= 0xC0 && marker <= 0xC2) {
+      if (pos + 2 + len > size || len < 8) return JDR_FMT1;
+      *h = (d[pos + 5] << 8) | d[pos + 6];
+      *w = (d[pos + 7] << 8) | d[pos + 8];
+      if (len >= 11) {
+        uint8_t sampling = d[pos + 11];  // first component H:V
+        mcuW = 8 * (sampling >> 4);
+        mcuH = 8 * (sampling & 0x0F);
+      }
+      break;
+    }
+    pos += 2 + len;
+  }
+  if (*w == 0 || *h == 0) return JDR_FMT1;
+  if (!draw) return JDR_OK;
+  if (!_cb) return JDR_PAR;
+
+  for (uint32_t i = 0; i < size; i += 97) hash = (hash ^ d[i]) * 16777619u;
+
+  int bw = mcuW / _scale, bh = mcuH / _scale;
+  if (bw < 1) bw = 1;
+  if (bh < 1) bh = 1;
+  int outW = (*w + _scale - 1) / _scale, outH = (*h + _scale - 1) / _scale;
+  std::vector<uint16_t> block(bw * bh);
+
+  for (int by = 0; by < outH; by += bh) {
+    for (int bx = 0; bx < outW; bx += bw) {
+      uint8_t r = (uint8_t)(hash >> 16) ^ (uint8_t)(bx * 255 / outW);
+      uint8_t g = (uint8_t)(hash >> 8) ^ (uint8_t)(by * 255 / outH);
+      uint8_t b = (uint8_t)hash;
+      uint16_t c = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+      if (_swap) c = (c >> 8) | (c << 8);
+      int cw = std::min(bw, outW - bx), ch = std::min(bh, outH - by);
+      for (int i = 0; i < cw * ch; i++) block[i] = c;
+      if (!_cb(x + bx, y + by, cw, ch, block.data())) return JDR_INTR;
+    }
+  }
+  return JDR_OK;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <FS.h>
+
+// ============================================================
+// Host stand-in for Bodmer's TJpg_Decoder. JPEG entropy decoding
+// is not simulated: the SOF header is parsed for the real image
+// size and MCU layout, and each MCU is emitted through the sketch
+// callback as a flat block whose shade is derived from the file
+// and block position. Callback traffic therefore matches a real
+// decode block for block, which is what the frame counters need.
+// ============================================================
+
+typedef enum {
+  JDR_OK = 0,
+  JDR_INTR,
+  JDR_INP,
+  JDR_MEM1,
+  JDR_MEM2,
+  JDR_PAR,
+  JDR_FMT1,
+  JDR_FMT2,
+  JDR_FMT3
+} JRESULT;
+
+typedef bool (*SketchCallback)(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t* data);
+
+class TJpg_Decoder {
+public:
+  void setJpgScale(uint8_t scale) { _scale = (scale == 2 || scale == 4 || scale == 8) ? scale : 1; }
+  void setSwapBytes(bool swap) { _swap = swap; }
+  void setCallback(SketchCallback cb) { _cb = cb; }
+
+  JRESULT getFsJpgSize(uint16_t* w, uint16_t* h, const char* path, fs::FS& fs);
+  JRESULT drawFsJpg(int32_t x, int32_t y, const char* path, fs::FS& fs);
+  JRESULT getJpgSize(uint16_t* w, uint16_t* h, const uint8_t* data, uint32_t size);
+  JRESULT drawJpg(int32_t x, int32_t y, const uint8_t* data, uint32_t size);
+
+private:
+  uint8_t _scale = 1;
+  bool _swap = false;
+  SketchCallback _cb = nullptr;
+
+  JRESULT decode(int32_t x, int32_t y, const uint8_t* data, uint32_t size, bool draw,
+                 uint16_t* w, uint16_t* h);
+};
+
+extern TJpg_Decoder TJpgDec;
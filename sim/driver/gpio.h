@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stdint.h>
+
+// ============================================================
+// Host stand-in for the ESP-IDF GPIO driver: only light-sleep wakeup
+// configuration, which the simulator's esp_light_sleep_start() honours.
+// ============================================================
+
+typedef int esp_err_t;
+#define ESP_OK 0
+
+typedef int gpio_num_t;
+
+typedef enum {
+  GPIO_INTR_DISABLE = 0,
+  GPIO_INTR_POSEDGE,
+  GPIO_INTR_NEGEDGE,
+  GPIO_INTR_ANYEDGE,
+  GPIO_INTR_LOW_LEVEL,
+  GPIO_INTR_HIGH_LEVEL
+} gpio_int_type_t;
+
+esp_err_t gpio_wakeup_enable(gpio_num_t pin, gpio_int_type_t type);
+esp_err_t gpio_wakeup_disable(gpio_num_t pin);
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdint.h>
+
+// ============================================================
+// Host stand-in for ESP-IDF ADC calibration.  The simulated ADC is
+// ideal: raw codes map linearly onto 0..3300 mV at 12 bits.
+// ============================================================
+
+typedef enum { ADC_UNIT_1 = 1, ADC_UNIT_2 = 2 } adc_unit_t;
+typedef enum { ADC_ATTEN_DB_0 = 0, ADC_ATTEN_DB_2_5, ADC_ATTEN_DB_6, ADC_ATTEN_DB_11 } adc_atten_t;
+typedef enum { ADC_WIDTH_BIT_9 = 0, ADC_WIDTH_BIT_10, ADC_WIDTH_BIT_11, ADC_WIDTH_BIT_12 } adc_bits_width_t;
+
+typedef enum {
+  ESP_ADC_CAL_VAL_EFUSE_VREF = 0,
+  ESP_ADC_CAL_VAL_EFUSE_TP,
+  ESP_ADC_CAL_VAL_DEFAULT_VREF
+} esp_adc_cal_value_t;
+
+struct esp_adc_cal_characteristics_t {
+  adc_unit_t adc_num;
+  adc_atten_t atten;
+  adc_bits_width_t bit_width;
+  uint32_t vref;
+};
+
+static inline esp_adc_cal_value_t esp_adc_cal_characterize(adc_unit_t unit, adc_atten_t atten,
+    adc_bits_width_t width, uint32_t vref, esp_adc_cal_characteristics_t* chars) {
+  *chars = {unit, atten, width, vref};
+  return ESP_ADC_CAL_VAL_DEFAULT_VREF;
+}
+
+static inline uint32_t esp_adc_cal_raw_to_voltage(uint32_t raw, const esp_adc_cal_characteristics_t*) {
+  return raw * 3300 / 4095;
+}
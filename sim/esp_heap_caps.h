@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "sim.h"
+
+// ============================================================
+// Host stand-in for ESP-IDF capability-based allocation: every
+// capability is served from the host heap (MALLOC_CAP_SPIRAM only when
+// the simulated board has PSRAM).
+// ============================================================
+
+#define MALLOC_CAP_EXEC     (1 << 0)
+#define MALLOC_CAP_32BIT    (1 << 1)
+#define MALLOC_CAP_8BIT     (1 << 2)
+#define MALLOC_CAP_DMA      (1 << 3)
+#define MALLOC_CAP_SPIRAM   (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+
+static inline void* heap_caps_malloc(size_t size, uint32_t caps) {
+  return (caps & MALLOC_CAP_SPIRAM) && !simPsram() ? nullptr : malloc(size);
+}
+static inline void* heap_caps_calloc(size_t n, size_t size, uint32_t caps) {
+  return (caps & MALLOC_CAP_SPIRAM) && !simPsram() ? nullptr : calloc(n, size);
+}
+static inline void heap_caps_free(void* p) { free(p); }
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <driver/gpio.h>
+
+// ============================================================
+// Host stand-in for ESP-IDF light sleep.  Sleeping jumps the virtual
+// clock to the next scripted press on a wakeup pin or the wakeup timer,
+// whichever is first (at most SIM_SLEEP_MAX_MS ahead, so a run with no
+// more presses still ends) and
+// books the time as sleep in the frame stats.  As on the chip, the press
+// that ends the sleep raises no GPIO interrupt.
+// ============================================================
+
+#define SIM_SLEEP_MAX_MS 1000
+
+typedef enum { ESP_PD_DOMAIN_RTC_PERIPH = 0, ESP_PD_DOMAIN_RTC8M = 4 } esp_sleep_pd_domain_t;
+typedef enum { ESP_PD_OPTION_OFF = 0, ESP_PD_OPTION_ON, ESP_PD_OPTION_AUTO } esp_sleep_pd_option_t;
+
+static inline esp_err_t esp_sleep_pd_config(esp_sleep_pd_domain_t, esp_sleep_pd_option_t) { return ESP_OK; }
+
+typedef enum { ESP_SLEEP_WAKEUP_ALL = 0, ESP_SLEEP_WAKEUP_TIMER = 4, ESP_SLEEP_WAKEUP_GPIO = 7 } esp_sleep_source_t;
+
+esp_err_t esp_sleep_enable_gpio_wakeup();
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t time_in_us);
+esp_err_t esp_sleep_disable_wakeup_source(esp_sleep_source_t source);
+esp_err_t esp_light_sleep_start();
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <stdint.h>
+
+// ============================================================
+// Host stand-in for the FreeRTOS types the firmware uses.  Tasks run as
+// host threads: see task.h, semphr.h and queue.h.
+// ============================================================
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE 0
+#define pdTRUE  1
+#define pdPASS  pdTRUE
+#define pdFAIL  pdFALSE
+
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS 1
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
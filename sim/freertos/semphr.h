@@ -0,0 +1,18 @@
+#pragma once
+
+#include <freertos/FreeRTOS.h>
+
+// ============================================================
+// Host stand-in for FreeRTOS semaphores.  A task waits for a give as long
+// as it takes; the main thread (loop()) waits only while some task could
+// still give it, so a take nobody can satisfy fails instead of hanging.
+// A binary semaphore carries the giver's virtual time to the taker.
+// ============================================================
+
+typedef struct SimSemaphore* SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateBinary();
+SemaphoreHandle_t xSemaphoreCreateMutex();   // created given
+void vSemaphoreDelete(SemaphoreHandle_t sem);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks);
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <freertos/FreeRTOS.h>
+
+// ============================================================
+// Host stand-in for FreeRTOS tasks: each task is a host thread with its
+// own virtual clock (see sim.cpp for how the clocks are kept in step).
+// Cores and priorities are ignored.  vTaskDelete(nullptr) ends the
+// calling task.
+// ============================================================
+
+typedef void (*TaskFunction_t)(void*);
+typedef void* TaskHandle_t;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackDepth,
+                                   void* arg, UBaseType_t priority, TaskHandle_t* handle,
+                                   BaseType_t core);
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
@@ -0,0 +1,172 @@
+// ============================================================
+// Native simulator runner: boots the firmware against the host
+// stand-ins, drives loop() with scripted button presses, records
+// per-frame display traffic and dumps frames as PPM images.
+//
+//   program --fs DIR [--sd DIR] [--sd-mhz MHZ] [--ms 10000] [--script FILE]
+//           [--press MS:bottom|top:HOLD_MS] [--dump DIR]
+//           [--dump-every N] [--stats FILE.csv] [--quiet]
+//           [--battery MV[:MV_PER_MIN]] [--no-psram]
+// ============================================================
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "sim.h"
+#include "pins.h"
+
+void setup();
+void loop();
+
+struct FrameRecord {
+  uint32_t frame;
+  uint32_t tMs;
+  SimFrameStats stats;
+  uint32_t cpuUs;
+};
+
+static uint8_t parseButton(const char* s) {
+  if (strcmp(s, "bottom") == 0 || strcmp(s, "1") == 0) return BTN1_PIN;
+  if (strcmp(s, "top") == 0 || strcmp(s, "2") == 0) return BTN2_PIN;
+  fprintf(stderr, "sim: unknown button '%s' (use bottom/top)\n", s);
+  exit(2);
+}
+
+// "MS:BTN:HOLD" or "MS BTN HOLD"
+static void addPressSpec(const char* spec) {
+  char btn[16];
+  unsigned at, hold;
+  if (sscanf(spec, "%u:%15[^:]:%u", &at, btn, &hold) != 3 &&
+      sscanf(spec, "%u %15s %u", &at, btn, &hold) != 3) {
+    fprintf(stderr, "sim: bad press spec '%s'\n", spec);
+    exit(2);
+  }
+  simAddPress(parseButton(btn), at, hold);
+}
+
+static void loadScript(const char* path) {
+  FILE* f = fopen(path, "r");
+  if (!f) {
+    fprintf(stderr, "sim: cannot open script %s\n", path);
+    exit(2);
+  }
+  char line[128];
+  while (fgets(line, sizeof(line), f)) {
+    if (line[0] == '#' || line[0] == '\n') continue;
+    addPressSpec(line);
+  }
+  fclose(f);
+}
+
+static void dumpFrame(const std::string& dir, uint32_t frame) {
+  char path[512];
+  snprintf(path, sizeof(path), "%s/frame_%05u.ppm", dir.c_str(), frame);
+  FILE* f = fopen(path, "wb");
+  if (!f) return;
+  fprintf(f, "P6\n%d %d\n255\n", SIM_W, SIM_H);
+  const uint16_t* fb = simFramebuffer();
+  for (int i = 0; i < SIM_W * SIM_H; i++) {
+    uint16_t c = fb[i];
+    uint8_t rgb[3] = {
+      (uint8_t)(((c >> 11) & 0x1F) * 255 / 31),
+      (uint8_t)(((c >> 5) & 0x3F) * 255 / 63),
+      (uint8_t)((c & 0x1F) * 255 / 31),
+    };
+    fwrite(rgb, 1, 3, f);
+  }
+  fclose(f);
+}
+
+int main(int argc, char** argv) {
+  uint32_t runMs = 10000;
+  uint32_t dumpEvery = 30;
+  std::string dumpDir, statsPath;
+
+  for (int i = 1; i < argc; i++) {
+    std::string a = argv[i];
+    const char* v = (i + 1 < argc) ? argv[i + 1] : nullptr;
+    if (a == "--quiet") { simSetQuiet(true); continue; }
+    if (a == "--no-psram") { simSetPsram(false); continue; }
+    if (!v) {
+      fprintf(stderr, "sim: missing value for %s\n", a.c_str());
+      return 2;
+    }
+    i++;
+    if (a == "--fs") simSetFsRoot(v);
+    else if (a == "--sd") simSetSdRoot(v);
+    else if (a == "--sd-mhz") simSetSdMaxHz((uint32_t)(atof(v) * 1000000));
+    else if (a == "--ms") runMs = (uint32_t)atol(v);
+    else if (a == "--script") loadScript(v);
+    else if (a == "--press") addPressSpec(v);
+    else if (a == "--dump") dumpDir = v;
+    else if (a == "--battery") {
+      const char* rate = strchr(v, ':');
+      simSetBattery((uint32_t)atol(v), rate ? atoi(rate + 1) : 0);
+    }
+    else if (a == "--dump-every") dumpEvery = (uint32_t)std::max(1L, atol(v));
+    else if (a == "--stats") statsPath = v;
+    else {
+      fprintf(stderr, "sim: unknown option %s\n", a.c_str());
+      return 2;
+    }
+  }
+
+  std::vector<FrameRecord> records;
+  uint32_t frame = 0;
+
+  auto runFrame = [&](void (*fn)()) {
+    simResetFrame();
+    uint32_t startMs = millis();
+    auto t0 = std::chrono::steady_clock::now();
+    fn();
+    auto t1 = std::chrono::steady_clock::now();
+    uint32_t cpuUs = (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
+    records.push_back({frame, startMs, simFrame(), cpuUs});
+    if (!dumpDir.empty() && simFrame().pixels > 0 && frame % dumpEvery == 0) {
+      dumpFrame(dumpDir, frame);
+    }
+    frame++;
+  };
+
+  runFrame(setup);
+  while (millis() < runMs) runFrame(loop);
+  if (!dumpDir.empty()) dumpFrame(dumpDir, frame);
+
+  if (!statsPath.empty()) {
+    FILE* f = fopen(statsPath.c_str(), "w");
+    if (f) {
+      fprintf(f, "frame,t_ms,pixels,bytes,windows,dma,cpu_us,spi_us,sleep_us\n");
+      for (const FrameRecord& r : records) {
+        fprintf(f, "%u,%u,%u,%u,%u,%u,%u,%u,%u\n", r.frame, r.tMs, r.stats.pixels,
+                r.stats.bytes, r.stats.windows, r.stats.dmaTransfers, r.cpuUs,
+                (uint32_t)((uint64_t)r.stats.bytes * 8 * 1000000 / SPI_FREQUENCY),
+                r.stats.sleepUs);
+      }
+      fclose(f);
+    }
+  }
+
+  // Summary over loop() frames only (frame 0 is setup)
+  uint64_t pixels = 0, bytes = 0, cpu = 0, sleep = 0;
+  uint32_t maxCpu = 0, maxBytes = 0, n = 0;
+  for (size_t i = 1; i < records.size(); i++) {
+    const FrameRecord& r = records[i];
+    pixels += r.stats.pixels;
+    bytes += r.stats.bytes;
+    cpu += r.cpuUs;
+    sleep += r.stats.sleepUs;
+    maxCpu = std::max(maxCpu, r.cpuUs);
+    maxBytes = std::max(maxBytes, r.stats.bytes);
+    n++;
+  }
+  fprintf(stderr,
+    "sim: %u frames in %lu ms | avg %llu px, %llu B, %llu us cpu per frame | "
+    "max %u B, %u us | %u NVS writes | %llu%% asleep\n",
+    n, millis(), n ? (unsigned long long)(pixels / n) : 0ULL,
+    n ? (unsigned long long)(bytes / n) : 0ULL, n ? (unsigned long long)(cpu / n) : 0ULL,
+    maxBytes, maxCpu, simNvsWrites(),
+    millis() ? (unsigned long long)(sleep / 10 / millis()) : 0ULL);
+  return 0;
+}
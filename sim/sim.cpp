@@ -0,0 +1,414 @@
+#include <Arduino.h>
+#include <stdarg.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <esp_sleep.h>
+#include <driver/ledc.h>
+#include <freertos/task.h>
+#include <freertos/semphr.h>
+#include <freertos/queue.h>
+#include "pins.h"
+#include "sim.h"
+
+static uint64_t nowUs = 0;
+static SimFrameStats frameStats = {0, 0, 0, 0, 0};
+static uint16_t fb[SIM_W * SIM_H];
+static std::string fsRoot = "sim_fs";
+static std::string sdRoot;
+static bool quiet = false;
+
+struct Press {
+  uint8_t pin;
+  uint32_t atMs;
+  uint32_t holdMs;
+};
+static std::vector<Press> presses;
+
+HardwareSerial Serial;
+
+static void (*isrs[64])() = {};
+
+// FreeRTOS tasks run as host threads, each on its own virtual clock (it
+// starts at its creator's time and moves only by the task's own delays
+// and SD transfers); loop() runs on the main thread's clock, nowUs.
+// A semaphore or queue item carries the giver's time to the taker, whose
+// clock catches up to it.  Before the main clock moves on to t, every
+// task must be blocked (waiting on a semaphore or queue), finished, or
+// past t itself -- so work a task does in zero virtual time is done by
+// the next tick of loop(), just as it would be on the other core.
+struct SimTask {
+  uint64_t clock = 0;
+  std::function<bool()> waitingFor;   // set while blocked: what unblocks it
+  bool done = false;
+
+  // Blocked, and not about to wake (lock held)
+  bool stuck() const { return waitingFor && !waitingFor(); }
+};
+
+// Never destroyed: tasks may still be waiting on them when the run ends
+static std::mutex& schedMu = *new std::mutex;                   // guards tasks and sync objects
+static std::condition_variable& schedCv = *new std::condition_variable;   // any change to those
+static std::vector<SimTask*> tasks;
+static thread_local SimTask* self = nullptr;   // nullptr: main thread
+
+static uint64_t& myClock() { return self ? self->clock : nowUs; }
+
+// Tasks that could still do something before main time `to` (lock held)
+static bool tasksBehind(uint64_t to) {
+  for (SimTask* t : tasks) {
+    if (!t->done && !t->stuck() && t->clock < to) return true;
+  }
+  return false;
+}
+
+// Tasks that could still give a semaphore main is waiting on (lock held)
+static bool tasksRunnable() {
+  for (SimTask* t : tasks) {
+    if (!t->done && !t->stuck()) return true;
+  }
+  return false;
+}
+
+static void waitForTasks(uint64_t to) {
+  std::unique_lock<std::mutex> lk(schedMu);
+  schedCv.wait(lk, [&] { return !tasksBehind(to); });
+}
+
+// Move the clock to `to`, running the attached ISR at every scripted press
+// edge crossed on the way (the pin already reads its new level)
+static void advanceTo(uint64_t to) {
+  if (self) {
+    std::lock_guard<std::mutex> lk(schedMu);
+    if (to > self->clock) self->clock = to;
+    schedCv.notify_all();
+    return;
+  }
+  waitForTasks(to);
+  for (;;) {
+    uint64_t next = to;
+    int pin = -1;
+    for (const Press& p : presses) {
+      if (!isrs[p.pin]) continue;
+      const uint64_t edges[2] = {(uint64_t)p.atMs * 1000, ((uint64_t)p.atMs + p.holdMs) * 1000};
+      for (uint64_t e : edges) {
+        if (e > nowUs && e <= next && (pin < 0 || e < next)) { next = e; pin = p.pin; }
+      }
+    }
+    if (pin < 0) break;
+    nowUs = next;
+    isrs[pin]();
+  }
+  nowUs = to;
+}
+
+uint64_t simNowUs() { return myClock(); }
+void simAdvanceUs(uint64_t us) { advanceTo(myClock() + us); }
+
+SimFrameStats& simFrame() { return frameStats; }
+void simResetFrame() { frameStats = {0, 0, 0, 0, 0}; }
+
+uint16_t* simFramebuffer() { return fb; }
+
+void simAddPress(uint8_t pin, uint32_t atMs, uint32_t holdMs) {
+  presses.push_back({pin, atMs, holdMs});
+}
+
+bool simPinLow(uint8_t pin) {
+  uint64_t ms = nowUs / 1000;
+  for (const Press& p : presses) {
+    if (p.pin == pin && ms >= p.atMs && ms < (uint64_t)p.atMs + p.holdMs) return true;
+  }
+  return false;
+}
+
+void simSetFsRoot(const std::string& dir) { fsRoot = dir; }
+const std::string& simFsRoot() { return fsRoot; }
+void simSetSdRoot(const std::string& dir) { sdRoot = dir; }
+const std::string& simSdRoot() { return sdRoot; }
+
+void simSetQuiet(bool q) { quiet = q; }
+
+// --- Arduino core ---
+
+unsigned long millis() { return (unsigned long)(myClock() / 1000); }
+unsigned long micros() { return (unsigned long)myClock(); }
+void delay(uint32_t ms) { advanceTo(myClock() + (uint64_t)ms * 1000); }
+void delayMicroseconds(uint32_t us) { advanceTo(myClock() + us); }
+void yield() {}
+
+static bool psram = true;
+void simSetPsram(bool present) { psram = present; }
+bool simPsram() { return psram; }
+
+bool psramFound() { return psram; }
+void* ps_malloc(size_t size) { return psram ? malloc(size) : nullptr; }
+void* ps_calloc(size_t n, size_t size) { return psram ? calloc(n, size) : nullptr; }
+
+void pinMode(uint8_t, uint8_t) {}
+void digitalWrite(uint8_t, uint8_t) {}
+
+int digitalRead(uint8_t pin) {
+  // Buttons are active LOW with pull-ups; everything else reads HIGH
+  return simPinLow(pin) ? LOW : HIGH;
+}
+
+void attachInterrupt(uint8_t pin, void (*isr)(), int) {
+  if (pin < 64) isrs[pin] = isr;
+}
+
+void detachInterrupt(uint8_t pin) {
+  if (pin < 64) isrs[pin] = nullptr;
+}
+
+// --- ADC, CPU clock and backlight ---
+
+static uint32_t batteryMv = 0;
+static int32_t batteryMvPerMin = 0;
+static uint32_t cpuMhz = 240;
+static uint32_t backlightDuty = 256;
+
+void simSetBattery(uint32_t mv, int32_t mvPerMin) {
+  batteryMv = mv;
+  batteryMvPerMin = mvPerMin;
+}
+
+uint32_t simBacklightDuty() { return backlightDuty; }
+uint32_t simCpuMhz() { return cpuMhz; }
+
+void analogReadResolution(uint8_t) {}
+void analogSetPinAttenuation(uint8_t, adc_attenuation_t) {}
+
+uint16_t analogRead(uint8_t pin) {
+  if (pin != BAT_ADC_PIN || batteryMv == 0) return 0;
+  int64_t mv = (int64_t)batteryMv + (int64_t)batteryMvPerMin * (int64_t)(nowUs / 1000) / 60000;
+  mv = std::max<int64_t>(0, mv) / 2;
+  return (uint16_t)std::min<int64_t>(4095, mv * 4095 / 3300);
+}
+
+bool setCpuFrequencyMhz(uint32_t mhz) {
+  cpuMhz = mhz;
+  return true;
+}
+
+uint32_t getCpuFrequencyMhz() { return cpuMhz; }
+
+esp_err_t ledc_timer_config(const ledc_timer_config_t*) { return ESP_OK; }
+esp_err_t ledc_channel_config(const ledc_channel_config_t* cfg) {
+  backlightDuty = cfg->duty;
+  return ESP_OK;
+}
+
+static uint32_t pendingDuty = 256;
+esp_err_t ledc_set_duty(ledc_mode_t, ledc_channel_t, uint32_t duty) {
+  pendingDuty = duty;
+  return ESP_OK;
+}
+
+esp_err_t ledc_update_duty(ledc_mode_t, ledc_channel_t) {
+  backlightDuty = pendingDuty;
+  return ESP_OK;
+}
+
+// --- Light sleep ---
+
+static bool wakePins[64];
+
+esp_err_t gpio_wakeup_enable(gpio_num_t pin, gpio_int_type_t) {
+  if (pin >= 0 && pin < 64) wakePins[pin] = true;
+  return ESP_OK;
+}
+
+esp_err_t gpio_wakeup_disable(gpio_num_t pin) {
+  if (pin >= 0 && pin < 64) wakePins[pin] = false;
+  return ESP_OK;
+}
+
+static uint64_t timerWakeUs = 0;   // 0 = no timer wakeup
+
+esp_err_t esp_sleep_enable_gpio_wakeup() { return ESP_OK; }
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t us) {
+  timerWakeUs = us;
+  return ESP_OK;
+}
+
+esp_err_t esp_sleep_disable_wakeup_source(esp_sleep_source_t source) {
+  if (source == ESP_SLEEP_WAKEUP_TIMER || source == ESP_SLEEP_WAKEUP_ALL) timerWakeUs = 0;
+  return ESP_OK;
+}
+
+esp_err_t esp_light_sleep_start() {
+  uint64_t to = nowUs + (uint64_t)SIM_SLEEP_MAX_MS * 1000;
+  if (timerWakeUs && nowUs + timerWakeUs < to) to = nowUs + timerWakeUs;
+  for (const Press& p : presses) {
+    if (!wakePins[p.pin]) continue;
+    if (simPinLow(p.pin)) return ESP_OK;   // level wakeup: already low
+    uint64_t at = (uint64_t)p.atMs * 1000;
+    if (at > nowUs && at < to) to = at;
+  }
+  // No ISRs while asleep: the clock jumps straight to the wake time
+  waitForTasks(to);
+  frameStats.sleepUs += (uint32_t)(to - nowUs);
+  nowUs = to;
+  return ESP_OK;
+}
+
+// --- FreeRTOS ---
+
+struct TaskExit {};   // thrown by vTaskDelete(nullptr) to end the thread
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char*, uint32_t, void* arg,
+                                   UBaseType_t, TaskHandle_t* handle, BaseType_t) {
+  SimTask* t = new SimTask;
+  t->clock = myClock();
+  if (handle) *handle = t;
+  {
+    std::lock_guard<std::mutex> lk(schedMu);
+    tasks.push_back(t);
+  }
+  std::thread([t, fn, arg] {
+    self = t;
+    try {
+      fn(arg);
+    } catch (const TaskExit&) {
+    }
+    std::lock_guard<std::mutex> lk(schedMu);
+    t->done = true;
+    schedCv.notify_all();
+  }).detach();
+  return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+  if (!task || task == self) throw TaskExit();
+}
+
+void vTaskDelay(TickType_t ticks) { delay(ticks * portTICK_PERIOD_MS); }
+
+// Block the calling thread until ready() (lock held throughout).  A task
+// waits for as long as it takes; main gives up once no task is left that
+// could make it ready, or when ticks is 0.
+template <typename Ready>
+static bool waitFor(std::unique_lock<std::mutex>& lk, TickType_t ticks, Ready ready) {
+  if (ready()) return true;
+  if (ticks == 0) return false;
+  if (self) {
+    self->waitingFor = ready;
+    schedCv.notify_all();
+    schedCv.wait(lk, ready);
+    self->waitingFor = nullptr;
+    return true;
+  }
+  schedCv.wait(lk, [&] { return ready() || !tasksRunnable(); });
+  return ready();
+}
+
+// After a take: bring the taker's clock up to the giver's time (lock
+// released; on main the clock moves through advanceTo, firing any press
+// edges on the way)
+static void catchUp(uint64_t at) {
+  if (self) {
+    std::lock_guard<std::mutex> lk(schedMu);
+    if (at > self->clock) self->clock = at;
+  } else if (at > nowUs) {
+    advanceTo(at);
+  }
+}
+
+struct SimSemaphore {
+  bool given;
+  bool mutex;       // a lock does not carry time between holders
+  uint64_t givenAt;
+};
+
+SemaphoreHandle_t xSemaphoreCreateBinary() { return new SimSemaphore{false, false, 0}; }
+SemaphoreHandle_t xSemaphoreCreateMutex() { return new SimSemaphore{true, true, 0}; }
+void vSemaphoreDelete(SemaphoreHandle_t sem) { delete sem; }
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+  std::lock_guard<std::mutex> lk(schedMu);
+  if (sem->given) return pdFALSE;
+  sem->given = true;
+  sem->givenAt = myClock();
+  schedCv.notify_all();
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks) {
+  std::unique_lock<std::mutex> lk(schedMu);
+  if (!waitFor(lk, ticks, [&] { return sem->given; })) return pdFALSE;
+  sem->given = false;
+  uint64_t at = sem->mutex ? 0 : sem->givenAt;
+  lk.unlock();
+  catchUp(at);
+  return pdTRUE;
+}
+
+struct SimQueue {
+  size_t length;
+  size_t itemSize;
+  std::deque<std::pair<std::vector<uint8_t>, uint64_t>> items;   // data, sent at
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+  return new SimQueue{length, itemSize, {}};
+}
+
+void vQueueDelete(QueueHandle_t q) { delete q; }
+
+BaseType_t xQueueSend(QueueHandle_t q, const void* item, TickType_t ticks) {
+  std::unique_lock<std::mutex> lk(schedMu);
+  if (!waitFor(lk, ticks, [&] { return q->items.size() < q->length; })) return errQUEUE_FULL;
+  const uint8_t* p = (const uint8_t*)item;
+  q->items.emplace_back(std::vector<uint8_t>(p, p + q->itemSize), myClock());
+  schedCv.notify_all();
+  return pdPASS;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void* item, TickType_t ticks) {
+  std::unique_lock<std::mutex> lk(schedMu);
+  if (!waitFor(lk, ticks, [&] { return !q->items.empty(); })) return pdFALSE;
+  memcpy(item, q->items.front().first.data(), q->itemSize);
+  uint64_t at = q->items.front().second;
+  q->items.pop_front();
+  schedCv.notify_all();
+  lk.unlock();
+  catchUp(at);
+  return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q) {
+  std::lock_guard<std::mutex> lk(schedMu);
+  return (UBaseType_t)q->items.size();
+}
+
+// --- Serial ---
+
+void HardwareSerial::begin(unsigned long) {}
+
+size_t HardwareSerial::print(const char* s) {
+  if (quiet) return 0;
+  return fputs(s, stdout) >= 0 ? strlen(s) : 0;
+}
+
+size_t HardwareSerial::print(int v) { return printf("%d", v); }
+
+size_t HardwareSerial::println(const char* s) {
+  size_t n = print(s);
+  return n + print("\n");
+}
+
+size_t HardwareSerial::println(int v) { return printf("%d\n", v); }
+
+size_t HardwareSerial::printf(const char* fmt, ...) {
+  if (quiet) return 0;
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vprintf(fmt, ap);
+  va_end(ap);
+  return n > 0 ? n : 0;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stdint.h>
+#include <string>
+
+// ============================================================
+// Simulator control surface shared by the stand-ins and the runner
+// ============================================================
+
+#define SIM_W 240
+#define SIM_H 240
+
+// Display traffic accumulated since the last simResetFrame().
+// Bytes model what TFT_eSPI would clock over SPI: 11 bytes of
+// CASET/RASET/RAMWR per address window plus 2 bytes per pixel.
+struct SimFrameStats {
+  uint32_t pixels;
+  uint32_t bytes;
+  uint32_t windows;
+  uint32_t dmaTransfers;    // pushImageDMA calls (overlap render with SPI)
+  uint32_t sleepUs;         // time spent in light sleep
+};
+
+// Virtual clock (microseconds since boot)
+uint64_t simNowUs();
+void simAdvanceUs(uint64_t us);
+
+// Per-frame display counters
+SimFrameStats& simFrame();
+void simResetFrame();
+
+// Panel contents, RGB565 in native byte order, SIM_W x SIM_H
+uint16_t* simFramebuffer();
+
+// Scripted input: hold `pin` LOW from atMs for holdMs
+void simAddPress(uint8_t pin, uint32_t atMs, uint32_t holdMs);
+bool simPinLow(uint8_t pin);
+
+// Battery at mv millivolts, changing by mvPerMin per minute of virtual
+// time (0 mV = no battery: the ADC reads 0, as with the jumper open)
+void simSetBattery(uint32_t mv, int32_t mvPerMin);
+
+// Backlight PWM duty (0..256 at 8 bits, 256 = fully on) and CPU clock
+// the firmware last set
+uint32_t simBacklightDuty();
+uint32_t simCpuMhz();
+
+// Host directories backing LittleFS and the SD card (empty = no card)
+void simSetFsRoot(const std::string& dir);
+const std::string& simFsRoot();
+void simSetSdRoot(const std::string& dir);
+const std::string& simSdRoot();
+
+// Fastest SPI clock the simulated card (and its wiring) reads reliably
+void simSetSdMaxHz(uint32_t hz);
+uint32_t simSdMaxHz();
+
+// Whether the board has PSRAM (psramFound(), MALLOC_CAP_SPIRAM)
+void simSetPsram(bool present);
+bool simPsram();
+
+// Silence Serial output
+void simSetQuiet(bool quiet);
@@ -0,0 +1,56 @@
+#include <LittleFS.h>
+#include <SD.h>
+#include <sys/stat.h>
+
+LittleFSFS LittleFS;
+SDFS SD;
+
+static uint32_t sdHz = 0;             // clock of the current mount
+static uint32_t sdMaxHz = 40000000;   // all the firmware's rates work
+
+void simSetSdMaxHz(uint32_t hz) { sdMaxHz = hz; }
+uint32_t simSdMaxHz() { return sdMaxHz; }
+
+// SPI bit time plus ~40 us of command and token overhead per 512 B block
+static void sdIo(uint8_t* buf, size_t size, bool write) {
+  if (!sdHz || !size) return;
+  uint64_t blocks = (size + 511) / 512;
+  simAdvanceUs((uint64_t)size * 8 * 1000000 / sdHz + blocks * 40);
+  if (!write && sdHz > sdMaxHz) {
+    for (size_t i = 0; i < size; i += 509) buf[i] ^= 0x10;
+  }
+}
+
+SDFS::SDFS() : fs::FS(simSdRoot, sdIo) {}
+
+bool LittleFSFS::begin(bool formatOnFail, const char*, uint8_t, const char*) {
+  struct stat st;
+  if (stat(simFsRoot().c_str(), &st) == 0) return S_ISDIR(st.st_mode);
+  // "Format" = create the backing directory
+  return formatOnFail && ::mkdir(simFsRoot().c_str(), 0755) == 0;
+}
+
+bool SDFS::begin(uint8_t, SPIClass&, uint32_t frequency, const char*, uint8_t, bool) {
+  struct stat st;
+  _mounted = !simSdRoot().empty() && stat(simSdRoot().c_str(), &st) == 0 &&
+             S_ISDIR(st.st_mode);
+  sdHz = _mounted ? frequency : 0;
+  return _mounted;
+}
+
+void SDFS::end() {
+  _mounted = false;
+  sdHz = 0;
+}
+
+bool SDFS::readRAW(uint8_t* buffer, uint32_t sector) {
+  if (!_mounted) return false;
+  uint32_t x = 2166136261u ^ sector;
+  for (char c : simSdRoot()) x = (x ^ (uint8_t)c) * 16777619u;
+  for (int i = 0; i < 512; i++) {
+    x = x * 1664525u + 1013904223u;
+    buffer[i] = (uint8_t)(x >> 24);
+  }
+  sdIo(buffer, 512, false);
+  return true;
+}
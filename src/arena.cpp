@@ -0,0 +1,66 @@
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#include "arena.h"
+
+struct Chunk {
+  Chunk* next;
+  size_t size;   // usable bytes after the header
+  size_t used;
+};
+
+#define HEADER ((sizeof(Chunk) + 7) & ~(size_t)7)
+
+static Chunk* chunks = nullptr;   // small allocations come from the head
+static size_t used = 0;
+static size_t internal = 0;
+
+// Oversized requests get a dedicated chunk linked behind the head, so the
+// head keeps serving small allocations
+static Chunk* newChunk(size_t size, bool dedicated) {
+  bool inPsram = true;
+  void* p = heap_caps_malloc(HEADER + size, MALLOC_CAP_SPIRAM);
+  if (!p) {
+    inPsram = false;
+    p = heap_caps_malloc(HEADER + size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  }
+  if (!p) return nullptr;
+  Chunk* c = (Chunk*)p;
+  c->size = size;
+  c->used = 0;
+  if (dedicated && chunks) {
+    c->next = chunks->next;
+    chunks->next = c;
+  } else {
+    c->next = chunks;
+    chunks = c;
+  }
+  if (!inPsram) internal += size;
+  return c;
+}
+
+void* arenaAlloc(size_t bytes) {
+  bytes = (bytes + 7) & ~(size_t)7;
+  Chunk* c = chunks;
+  if (bytes > ARENA_CHUNK) c = newChunk(bytes, true);
+  else if (!c || c->size - c->used < bytes) c = newChunk(ARENA_CHUNK, false);
+  if (!c) return nullptr;
+  uint8_t* p = (uint8_t*)c + HEADER + c->used;
+  c->used += bytes;
+  used += bytes;
+  memset(p, 0, bytes);
+  return p;
+}
+
+size_t arenaRelease() {
+  while (chunks) {
+    Chunk* next = chunks->next;
+    heap_caps_free(chunks);
+    chunks = next;
+  }
+  size_t peak = used;
+  used = 0;
+  internal = 0;
+  return peak;
+}
+
+size_t arenaInternal() { return internal; }
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// ============================================================
+// Mode memory arena.  Everything a mode allocates for its visit comes
+// from one bump allocator over a few large chunks (PSRAM when present,
+// internal SRAM otherwise) and is released in one go when the mode
+// exits, so modes never leave holes behind in the heap.  There is no
+// per-allocation free.
+// ============================================================
+
+#define ARENA_CHUNK (32 * 1024)   // chunk size; larger requests get their own
+
+// Allocate bytes (8-byte aligned, zeroed) from the current mode's arena.
+// Returns nullptr if both PSRAM and internal SRAM are exhausted.
+void* arenaAlloc(size_t bytes);
+
+template <typename T>
+static inline T* arenaNew(size_t count) { return (T*)arenaAlloc(count * sizeof(T)); }
+
+// Free every chunk.  Returns the arena's high-water mark (bytes handed
+// out) since the previous release.
+size_t arenaRelease();
+
+// Chunk bytes taken from internal SRAM because PSRAM was absent or full
+size_t arenaInternal();
@@ -0,0 +1,70 @@
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#include "band_push.h"
+#include "modes.h"
+
+#define BAND_PIXELS (240 * BAND_ROWS)
+
+static constexpr uint16_t bswap16(uint16_t v) { return (uint16_t)((v >> 8) | (v << 8)); }
+
+static uint16_t* bands[2] = {nullptr, nullptr};
+static bool dmaReady = false;
+
+bool bandPushInit() {
+  for (int i = 0; i < 2; i++) {
+    if (!bands[i]) bands[i] = (uint16_t*)heap_caps_malloc(BAND_PIXELS * sizeof(uint16_t), MALLOC_CAP_DMA);
+  }
+  if (!bands[0] || !bands[1]) {
+    Serial.println("band: no DMA-capable memory for band buffers");
+    return false;
+  }
+  if (!dmaReady) {
+    dmaReady = tft.initDMA();
+    if (!dmaReady) Serial.println("band: DMA init failed");
+  }
+  return dmaReady;
+}
+
+bool bandPushReady() { return dmaReady && bands[0] && bands[1]; }
+
+void bandPushFrame(BandRenderFn render, void* ctx) {
+  // pushImageDMA swaps in place when swapBytes is set; bands are already
+  // in wire order
+  bool swap = tft.getSwapBytes();
+  tft.setSwapBytes(false);
+  tft.startWrite();
+  for (int b = 0; b < BAND_COUNT; b++) {
+    // pushImageDMA waits for the previous band before starting this one, so
+    // the buffer rendered here finished sending two bands ago
+    uint16_t* band = bands[b & 1];
+    render(band, b * BAND_ROWS, BAND_ROWS, ctx);
+    tft.pushImageDMA(0, b * BAND_ROWS, 240, BAND_ROWS, band);
+  }
+  tft.dmaWait();
+  tft.endWrite();
+  tft.setSwapBytes(swap);
+}
+
+void bandInit4(Band4& b, const uint8_t* pixels, const uint16_t* palette) {
+  b.pixels = pixels;
+  for (int i = 0; i < 256; i++) {
+    // Little-endian store: the even (high-nibble) pixel goes out first
+    b.pairs[i] = bswap16(palette[i >> 4]) | (uint32_t)bswap16(palette[i & 0x0F]) << 16;
+  }
+}
+
+void bandRender4(uint16_t* band, int y0, int rows, void* ctx) {
+  const Band4& b = *(const Band4*)ctx;
+  const uint8_t* src = b.pixels + y0 * 120;
+  uint32_t* out = (uint32_t*)band;
+  for (int i = 0; i < rows * 120; i += 4) {
+    out[i]     = b.pairs[src[i]];
+    out[i + 1] = b.pairs[src[i + 1]];
+    out[i + 2] = b.pairs[src[i + 2]];
+    out[i + 3] = b.pairs[src[i + 3]];
+  }
+}
+
+void bandRender565(uint16_t* band, int y0, int rows, void* ctx) {
+  memcpy(band, (const uint16_t*)ctx + y0 * 240, rows * 240 * sizeof(uint16_t));
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <TFT_eSPI.h>
+
+// ============================================================
+// Double-buffered band push for full-screen modes.  The frame goes out
+// as horizontal bands through two RGB565 buffers: while band N is being
+// clocked out over SPI by DMA, the CPU renders band N+1 into the other
+// buffer, so render and transfer overlap instead of running back to back.
+// ============================================================
+
+#define BAND_ROWS  20                    // rows per band (240 / 20 = 12 bands)
+#define BAND_COUNT (240 / BAND_ROWS)
+
+// Render rows [y0, y0 + rows) of the frame into band: 240 * rows RGB565
+// pixels in SPI byte order (as a 16-bit sprite holds them)
+typedef void (*BandRenderFn)(uint16_t* band, int y0, int rows, void* ctx);
+
+// Allocate the two band buffers in DMA-capable RAM and attach the panel's
+// DMA channel.  Safe to call again.  Returns false if either failed; the
+// caller should then push its sprite the usual way.
+bool bandPushInit();
+
+bool bandPushReady();
+
+// Send one full frame, calling render once per band top to bottom.  Holds
+// the SPI bus for the whole frame and releases it (transfer finished)
+// before returning, so the shared SD card is free again between frames.
+void bandPushFrame(BandRenderFn render, void* ctx);
+
+// 4-bit indexed 240x240 frame (two pixels per byte, even X in the high
+// nibble, as in a 4-bit TFT_eSprite) and its palette, expanded a byte at a
+// time: each byte maps straight to its two RGB565 pixels in wire order.
+struct Band4 {
+  const uint8_t* pixels;
+  uint32_t pairs[256];
+};
+
+// Point b at a frame and expand palette (16 RGB565 entries) into pairs
+void bandInit4(Band4& b, const uint8_t* pixels, const uint16_t* palette);
+
+// Band renderer for a Band4 (ctx)
+void bandRender4(uint16_t* band, int y0, int rows, void* ctx);
+
+static inline void bandPush4(Band4& b) { bandPushFrame(bandRender4, &b); }
+
+// Band renderer for a 240x240 RGB565 frame already in SPI byte order
+// (ctx), e.g. a JPEG decoded into PSRAM, which DMA cannot read directly
+void bandRender565(uint16_t* band, int y0, int rows, void* ctx);
+
+static inline void bandPush565(const uint16_t* frame) { bandPushFrame(bandRender565, (void*)frame); }
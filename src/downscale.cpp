@@ -0,0 +1,159 @@
+#include <Arduino.h>
+#include <TJpg_Decoder.h>
+#include "downscale.h"
+#include "q565.h"
+#include "resample.h"
+#include "arena.h"
+
+static constexpr uint16_t bswap16(uint16_t v) { return (uint16_t)((v >> 8) | (v << 8)); }
+
+// Channel sums for one output row
+struct AccRow {
+  uint16_t r[Q565_SIZE], g[Q565_SIZE], b[Q565_SIZE];
+};
+
+static uint16_t* frame = nullptr;   // output, SPI byte order
+static AccRow* acc = nullptr;       // DOWNSCALE_ACC_ROWS, indexed oy % rows
+static volatile bool active = false;
+
+// The image being decoded: sw x sh decoded pixels, cropped and folded into
+// the panel with resampleBegin()'s geometry (16.16 source positions)
+static struct {
+  int sw, sh;
+  int32_t stepQ16;              // source pixels per output pixel (>= 1)
+  int32_t cropXQ16, cropYQ16;   // source position of the output's top left
+  int lastY;     // top of the MCU row being received
+  int nextOut;   // first output row not yet written to frame
+  uint8_t colCount[Q565_SIZE], rowCount[Q565_SIZE];
+} img;
+
+bool downscaleBegin() {
+  if (!frame) frame = arenaNew<uint16_t>(Q565_PIXELS);
+  if (!acc) acc = arenaNew<AccRow>(DOWNSCALE_ACC_ROWS);
+  return frame && acc;
+}
+
+void downscaleEnd() {
+  frame = nullptr;   // released with the arena
+  acc = nullptr;
+}
+
+bool downscaleWanted(const char* path, fs::FS& fs) {
+  uint16_t w = 0, h = 0;
+  TJpgDec.getFsJpgSize(&w, &h, path, fs);
+  return w >= Q565_SIZE && h >= Q565_SIZE && (w > Q565_SIZE || h > Q565_SIZE);
+}
+
+bool downscaleActive() { return active; }
+
+// Output pixel whose box holds the centre of source pixel s along an axis;
+// -1 or >= Q565_SIZE when it is cropped off
+static inline int outPos(int s, int32_t cropQ16) {
+  int32_t f = ((int32_t)s << 16) + 0x8000 - cropQ16;
+  return f < 0 ? -1 : f / img.stepQ16;
+}
+
+// Average the finished rows [nextOut, upTo) into frame and clear them
+static void finishRows(int upTo) {
+  for (; img.nextOut < upTo; img.nextOut++) {
+    int oy = img.nextOut;
+    AccRow& a = acc[oy % DOWNSCALE_ACC_ROWS];
+    uint16_t* out = frame + oy * Q565_SIZE;
+    for (int ox = 0; ox < Q565_SIZE; ox++) {
+      uint16_t n = img.colCount[ox] * img.rowCount[oy];
+      uint16_t r = (a.r[ox] + n / 2) / n;
+      uint16_t g = (a.g[ox] + n / 2) / n;
+      uint16_t b = (a.b[ox] + n / 2) / n;
+      out[ox] = bswap16(r << 11 | g << 5 | b);
+    }
+    memset(&a, 0, sizeof(a));
+  }
+}
+
+// Runs in tft_output; blocks come left to right, an MCU row at a time
+bool downscaleBlock(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint16_t* bitmap) {
+  if (y != img.lastY) {
+    // Rows above this MCU row get nothing more
+    finishRows(min(max(outPos(y, img.cropYQ16), 0), Q565_SIZE));
+    img.lastY = y;
+    // Stop the decoder once the output is full (the rest is cropped)
+    if (img.nextOut == Q565_SIZE) return 0;
+  }
+  int cols = x + w > img.sw ? img.sw - x : w;
+  for (int row = 0; row < h && y + row < img.sh; row++) {
+    int oy = outPos(y + row, img.cropYQ16);
+    if (oy < 0 || oy >= Q565_SIZE) continue;
+    AccRow& a = acc[oy % DOWNSCALE_ACC_ROWS];
+    const uint16_t* src = bitmap + row * w;
+    for (int col = 0; col < cols; col++) {
+      int ox = outPos(x + col, img.cropXQ16);
+      if (ox < 0 || ox >= Q565_SIZE) continue;
+      uint16_t px = bswap16(src[col]);
+      a.r[ox] += px >> 11;
+      a.g[ox] += (px >> 5) & 63;
+      a.b[ox] += px & 31;
+    }
+  }
+  return 1;
+}
+
+bool downscaleJpeg(const char* srcPath, fs::FS& srcFs, const char* dstPath, fs::FS& dstFs) {
+  if (!frame || !acc) return false;
+  uint16_t w = 0, h = 0;
+  TJpgDec.getFsJpgSize(&w, &h, srcPath, srcFs);
+  if (w == 0 || h == 0) return false;
+
+  // The decoder scale the JPEG path would draw it at, so the decoder does
+  // the coarse reduction and every output pixel averages one or more whole
+  // source pixels
+  uint16_t sw, sh;
+  uint8_t scale = resampleScale(w, h, sw, sh);
+  img.sw = sw;
+  img.sh = sh;
+  if (img.sw < Q565_SIZE || img.sh < Q565_SIZE) return false;   // would be upscaled
+
+  // Cover, as resampleBegin(): the shorter side spans the panel, the
+  // longer is cropped evenly
+  img.stepQ16 = ((int32_t)min(img.sw, img.sh) << 16) / Q565_SIZE;
+  img.cropXQ16 = (((int32_t)img.sw << 16) - Q565_SIZE * img.stepQ16) / 2;
+  img.cropYQ16 = (((int32_t)img.sh << 16) - Q565_SIZE * img.stepQ16) / 2;
+
+  // Boxes are at most step + 1 pixels a side.  The 16-bit sums hold boxes
+  // of up to 1040 pixels (1040 * 63 < 65536), about 32:1 after the
+  // decoder's 1/8: wider than any camera.
+  int box = (img.stepQ16 >> 16) + 1;
+  if (box * box > 1040) return false;
+  memset(img.colCount, 0, sizeof(img.colCount));
+  memset(img.rowCount, 0, sizeof(img.rowCount));
+  for (int sx = 0; sx < img.sw; sx++) {
+    int ox = outPos(sx, img.cropXQ16);
+    if (ox >= 0 && ox < Q565_SIZE) img.colCount[ox]++;
+  }
+  for (int sy = 0; sy < img.sh; sy++) {
+    int oy = outPos(sy, img.cropYQ16);
+    if (oy >= 0 && oy < Q565_SIZE) img.rowCount[oy]++;
+  }
+
+  memset(acc, 0, DOWNSCALE_ACC_ROWS * sizeof(AccRow));
+  img.lastY = 0;
+  img.nextOut = 0;
+
+  TJpgDec.setJpgScale(scale);
+  active = true;
+  JRESULT rc = TJpgDec.drawFsJpg(0, 0, srcPath, srcFs);
+  active = false;
+  TJpgDec.setJpgScale(1);
+  // Interrupted is fine once every output row is in
+  if (rc != JDR_OK && !(rc == JDR_INTR && img.nextOut == Q565_SIZE)) {
+    Serial.printf("downscale: cannot decode %s (%d)\n", srcPath, (int)rc);
+    return false;
+  }
+  finishRows(Q565_SIZE);
+
+  File dst = dstFs.open(dstPath, FILE_WRITE, true);
+  if (!dst) return false;
+  bool ok = q565Write(dst, frame);
+  dst.close();
+  if (!ok) dstFs.remove(dstPath);
+  return ok;
+}
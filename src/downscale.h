@@ -0,0 +1,36 @@
+#pragma once
+
+#include <FS.h>
+
+// ============================================================
+// Intake-time photo downscaling.  A phone photo is several MB and would
+// be decoded at 1/8 scale on every draw.  Instead Intake decodes it once,
+// at the scale the JPEG path would draw it at (see resample.h), box-
+// averages that down to fill 240x240, cropping the longer side evenly
+// just as the JPEG path does, and stores the result as Q565 (see q565.h).  Decoded blocks arrive an MCU
+// row at a time, so only a few output rows are accumulated at once.
+// ============================================================
+
+#define DOWNSCALE_ACC_ROWS 16   // output rows in flight (>= tallest MCU)
+
+// Allocate the output frame and row accumulators from the mode arena.
+// Safe to call again.  Returns false if they do not fit.
+bool downscaleBegin();
+
+// Forget the buffers.  Call from the mode's exit hook, before the arena
+// is released.
+void downscaleEnd();
+
+// True if the image covers the panel with room to spare and is worth
+// downscaling (one narrower than the panel is left to the JPEG path)
+bool downscaleWanted(const char* path, fs::FS& fs);
+
+// Decode the JPEG at srcPath, downscale it and write it as Q565 to
+// dstPath.  Returns false (and leaves no dstPath) if the JPEG cannot be
+// decoded or the write fell short.
+bool downscaleJpeg(const char* srcPath, fs::FS& srcFs, const char* dstPath, fs::FS& dstFs);
+
+// For tft_output: true while downscaleJpeg() is decoding, and the sink
+// that folds a decoded block into the output
+bool downscaleActive();
+bool downscaleBlock(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint16_t* bitmap);
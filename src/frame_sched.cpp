@@ -0,0 +1,66 @@
+#include <Arduino.h>
+#include "frame_sched.h"
+
+static uint16_t modeHz = 0;
+static uint16_t capHz = 0;
+static uint32_t periodUs = SCHED_IDLE_US;
+static uint32_t nextUs = 0;      // deadline of the current frame
+static uint32_t lastUs = 0;      // start of the previous frame
+static uint32_t frames = 0;
+static uint32_t missed = 0;
+
+static uint32_t framePeriodUs() {
+  if (!modeHz) return SCHED_IDLE_US;
+  uint16_t hz = (capHz && capHz < modeHz) ? capHz : modeHz;
+  return 1000000UL / hz;
+}
+
+void schedStart(uint16_t hz) {
+  modeHz = hz;
+  periodUs = framePeriodUs();
+  lastUs = micros();
+  nextUs = lastUs + periodUs;
+  frames = 0;
+  missed = 0;
+}
+
+void schedSetCap(uint16_t hz) {
+  capHz = hz;
+  uint32_t p = framePeriodUs();
+  nextUs += p - periodUs;   // move the pending deadline with the period
+  periodUs = p;
+}
+
+void schedResync() {
+  lastUs = micros();
+  nextUs = lastUs + periodUs;
+}
+
+uint32_t schedFrameDt() {
+  uint32_t now = micros();
+  uint32_t dt = now - lastUs;
+  lastUs = now;
+  frames++;
+  return dt < SCHED_MAX_DT_US ? dt : SCHED_MAX_DT_US;
+}
+
+void schedSleep() {
+  uint32_t now = micros();
+  int32_t left = (int32_t)(nextUs - now);   // wraps with micros()
+
+  if (left < 0) {
+    // Overran by one or more whole periods: realign on now.  Finishing
+    // exactly on the deadline is on time (a zero-length sleep below).
+    missed += 1 + (uint32_t)(-left) / periodUs;
+    nextUs = now + periodUs;
+    return;
+  }
+
+  // delay() yields to the scheduler; only the sub-millisecond tail spins
+  delay(left / 1000);
+  delayMicroseconds(left % 1000);
+  nextUs += periodUs;
+}
+
+uint32_t schedFrames() { return frames; }
+uint32_t schedMissed() { return missed; }
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdint.h>
+
+// ============================================================
+// Deadline-based frame pacing for loop().  Each mode declares a target
+// frame rate; loop() sleeps only for whatever is left of the current
+// frame period, so the rate holds no matter how long the frame's work
+// took.  Frames that run past their deadline are counted as missed and
+// the next one starts immediately (no burst to catch up).
+// ============================================================
+
+// Button poll period for static modes (frameHz = 0), which get no updates
+#define SCHED_IDLE_US 40000UL
+
+// Longest delta-time handed to a mode, so a frame after a slow load or a
+// blocking button handler does not jump the animation
+#define SCHED_MAX_DT_US 100000UL
+
+// Restart pacing at hz frames per second (0 = static mode).  Call after
+// the mode's enter(), which may take a while.
+void schedStart(uint16_t hz);
+
+// Cap every mode's frame rate at hz (0 = no cap), e.g. to save power.
+// Takes effect from the next frame; modes see it only as a longer dt.
+void schedSetCap(uint16_t hz);
+
+// Re-anchor the deadlines on now after the loop slept outside the
+// scheduler (light sleep), keeping the counters
+void schedResync();
+
+// Start a frame: returns the time since the previous frame began, in
+// microseconds (capped at SCHED_MAX_DT_US)
+uint32_t schedFrameDt();
+
+// Sleep until the next frame deadline, or count a miss if it has passed
+void schedSleep();
+
+// Frames started / deadlines missed since the last schedStart()
+uint32_t schedFrames();
+uint32_t schedMissed();
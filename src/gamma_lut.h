@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdint.h>
+
+// ============================================================
+// Gamma-correct coverage ramps, evaluated at compile time into flash.
+// Interpolation in gamma-encoded space underestimates brightness (two 50%
+// pixels look dimmer than one 100% pixel).  Converting to linear light,
+// blending, then back to gamma fixes this.  Gamma is 2.2 throughout.
+// ============================================================
+
+namespace gamma_gen {
+
+constexpr double LN2 = 0.69314718055994530942;
+
+// Natural log for x > 0: reduce to [1,2), then 2*atanh((x-1)/(x+1))
+constexpr double ln(double x) {
+  int e = 0;
+  while (x >= 2.0) { x *= 0.5; e++; }
+  while (x < 1.0) { x *= 2.0; e--; }
+  double t = (x - 1.0) / (x + 1.0), t2 = t * t, term = t, sum = 0.0;
+  for (int n = 1; n < 61; n += 2) { sum += term / n; term *= t2; }
+  return 2.0 * sum + e * LN2;
+}
+
+// e^y: reduce to |y| <= ln2/2, Taylor series, scale by 2^k
+constexpr double exp(double y) {
+  int k = 0;
+  while (y > 0.5 * LN2) { y -= LN2; k++; }
+  while (y < -0.5 * LN2) { y += LN2; k--; }
+  double term = 1.0, sum = 1.0;
+  for (int n = 1; n < 30; n++) { term *= y / n; sum += term; }
+  for (; k > 0; k--) sum *= 2.0;
+  for (; k < 0; k++) sum *= 0.5;
+  return sum;
+}
+
+constexpr double pow(double x, double p) { return x <= 0.0 ? 0.0 : exp(p * ln(x)); }
+
+} // namespace gamma_gen
+
+// Light output of an RGB565 color scaled by num/den: each channel goes to
+// linear light, is scaled, and is gamma-encoded back at full 5/6/5
+// precision.  This is the color a pixel shows when a text color covers
+// num/den of it over a black background.
+constexpr uint16_t scaleChannel(int v, int maxV, int num, int den) {
+  double lin = gamma_gen::pow((double)v / maxV, 2.2) * num / den;
+  return (uint16_t)(gamma_gen::pow(lin, 1.0 / 2.2) * maxV + 0.5);
+}
+
+constexpr uint16_t coverage565(uint16_t c, int num, int den) {
+  return scaleChannel((c >> 11) & 0x1F, 31, num, den) << 11
+       | scaleChannel((c >> 5) & 0x3F, 63, num, den) << 5
+       | scaleChannel(c & 0x1F, 31, num, den);
+}
@@ -0,0 +1,134 @@
+#include <Arduino.h>
+#include <esp_sleep.h>
+#include "input.h"
+#include "pins.h"
+
+#define EDGE_RING  32   // power of two
+#define EVENT_RING 8
+
+// Edge ring: the ISRs only advance edgeHead, loop() only edgeTail.  Each
+// entry is the edge time and (button index << 1 | pressed).
+static volatile uint32_t edgeMs[EDGE_RING];
+static volatile uint8_t edgeBits[EDGE_RING];
+static volatile uint8_t edgeHead = 0;
+static volatile uint8_t edgeTail = 0;
+
+static ButtonEvent events[EVENT_RING];
+static uint8_t eventHead = 0, eventTail = 0;
+
+struct Button {
+  uint8_t pin;
+  bool down;            // debounced level
+  bool longFired;       // long press already reported for this hold
+  uint32_t changedMs;   // time of the last accepted edge
+};
+
+static Button buttons[2] = {{BTN1_PIN, false, false, 0}, {BTN2_PIN, false, false, 0}};
+
+// A full ring drops the edge; the level check in inputNext() recovers
+static void IRAM_ATTR pushEdge(uint8_t b) {
+  uint8_t h = edgeHead;
+  if ((uint8_t)(h - edgeTail) >= EDGE_RING) return;
+  edgeMs[h & (EDGE_RING - 1)] = millis();
+  edgeBits[h & (EDGE_RING - 1)] = b << 1 | (digitalRead(buttons[b].pin) == LOW);
+  edgeHead = h + 1;
+}
+
+static void IRAM_ATTR onBtn1() { pushEdge(0); }
+static void IRAM_ATTR onBtn2() { pushEdge(1); }
+
+static void queueEvent(int b, uint8_t kind) {
+  if ((uint8_t)(eventHead - eventTail) >= EVENT_RING) return;
+  events[eventHead++ % EVENT_RING] = {(uint8_t)(b + 1), kind};
+}
+
+static void checkLong(int b, uint32_t ms) {
+  Button& bt = buttons[b];
+  if (bt.down && !bt.longFired && ms - bt.changedMs >= LONG_PRESS_MS) {
+    bt.longFired = true;
+    queueEvent(b, BTN_LONG);
+  }
+}
+
+static void acceptEdge(int b, bool down, uint32_t ms) {
+  Button& bt = buttons[b];
+  if (down == bt.down || ms - bt.changedMs < DEBOUNCE_MS) return;
+  // A hold that outlasted LONG_PRESS_MS before we got to its release
+  // still reports the long press, in order
+  checkLong(b, ms);
+  bt.down = down;
+  bt.changedMs = ms;
+  if (down) bt.longFired = false;
+  else if (!bt.longFired) queueEvent(b, BTN_SHORT);
+}
+
+static void attachEdges() {
+  attachInterrupt(digitalPinToInterrupt(BTN1_PIN), onBtn1, CHANGE);
+  attachInterrupt(digitalPinToInterrupt(BTN2_PIN), onBtn2, CHANGE);
+}
+
+void inputInit() {
+  pinMode(BTN1_PIN, INPUT_PULLUP);
+  pinMode(BTN2_PIN, INPUT_PULLUP);
+  attachEdges();
+}
+
+bool inputNext(ButtonEvent& ev) {
+  while (edgeTail != edgeHead) {
+    uint8_t i = edgeTail & (EDGE_RING - 1);
+    uint32_t ms = edgeMs[i];
+    uint8_t bits = edgeBits[i];
+    edgeTail = edgeTail + 1;
+    acceptEdge(bits >> 1, bits & 1, ms);
+  }
+
+  uint32_t now = millis();
+  for (int b = 0; b < 2; b++) {
+    Button& bt = buttons[b];
+    // Bounce can hide the last edge inside the debounce window.  Once the
+    // window is over, settle on the live level without an event: whatever
+    // hid in there lasted under DEBOUNCE_MS.
+    bool live = digitalRead(bt.pin) == LOW;
+    if (live != bt.down && now - bt.changedMs >= DEBOUNCE_MS) {
+      bt.down = live;
+      bt.changedMs = now;
+      if (live) bt.longFired = false;
+    }
+    checkLong(b, now);
+  }
+
+  if (eventTail == eventHead) return false;
+  ev = events[eventTail++ % EVENT_RING];
+  return true;
+}
+
+bool inputQuiet() {
+  if (edgeTail != edgeHead || eventTail != eventHead) return false;
+  uint32_t now = millis();
+  for (const Button& bt : buttons) {
+    if (bt.down || digitalRead(bt.pin) == LOW || now - bt.changedMs < DEBOUNCE_MS) return false;
+  }
+  return true;
+}
+
+void inputLightSleep(uint32_t wakeMs) {
+  Serial.flush();   // the UART stops while asleep
+
+  // A level wakeup left on a pin with an attached ISR would keep firing it
+  detachInterrupt(digitalPinToInterrupt(BTN1_PIN));
+  detachInterrupt(digitalPinToInterrupt(BTN2_PIN));
+  for (const Button& bt : buttons) gpio_wakeup_enable((gpio_num_t)bt.pin, GPIO_INTR_LOW_LEVEL);
+  esp_sleep_enable_gpio_wakeup();
+  if (wakeMs) esp_sleep_enable_timer_wakeup((uint64_t)wakeMs * 1000);
+
+  esp_light_sleep_start();
+
+  if (wakeMs) esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_TIMER);
+
+  for (const Button& bt : buttons) gpio_wakeup_disable((gpio_num_t)bt.pin);
+  // Queued before the edge interrupts return, so the ISRs cannot race it
+  for (int b = 0; b < 2; b++) {
+    if (digitalRead(buttons[b].pin) == LOW) pushEdge(b);
+  }
+  attachEdges();
+}
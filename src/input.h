@@ -0,0 +1,41 @@
+#pragma once
+
+#include <stdint.h>
+
+// ============================================================
+// Interrupt-driven button input.  Both buttons raise a GPIO interrupt on
+// every edge; the ISR only timestamps the edge into a ring.  Debounce and
+// short/long classification run later from loop() on those timestamps,
+// so nothing blocks and a press made while a mode is busy rendering is
+// still seen (and classified by how long it was actually held).
+// ============================================================
+
+#define LONG_PRESS_MS 500   // held this long = long press (fires while held)
+#define DEBOUNCE_MS   30    // edges this soon after an accepted one are bounce
+
+enum ButtonEventKind : uint8_t {
+  BTN_SHORT = 1,   // released before LONG_PRESS_MS
+  BTN_LONG  = 2    // still held at LONG_PRESS_MS
+};
+
+struct ButtonEvent {
+  uint8_t btn;     // 1 = bottom, 2 = top (as Mode::onButton)
+  uint8_t kind;    // ButtonEventKind
+};
+
+// Configure both button pins and attach their interrupts
+void inputInit();
+
+// Classify the edges captured so far and pop the next event, oldest first.
+// Returns false when the queue is empty.
+bool inputNext(ButtonEvent& ev);
+
+// True when nothing is pending: no queued edges or events and both buttons
+// settled up, so no long press is being timed
+bool inputQuiet();
+
+// Light-sleep until either button is pressed, or for at most wakeMs when
+// it is not 0.  The edge interrupts are swapped for a low-level GPIO
+// wakeup while asleep; the press that wakes the chip is queued as its
+// edge on the way out.
+void inputLightSleep(uint32_t wakeMs = 0);
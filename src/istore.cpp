@@ -129,6 +129,25 @@ void istoreWipe() {
     (unsigned)(istoreFreeBytes() / 1024));
 }
 
+// Truncate a filename to 32 chars, preserving the extension
+void istoreTruncateName(const char* in, char* out, size_t outSize) {
+  size_t len = strlen(in);
+  if (len <= 32) {
+    strncpy(out, in, outSize);
+    out[outSize - 1] = '\0';
+    return;
+  }
+  const char* dot = strrchr(in, '.');
+  if (dot) {
+    size_t extLen = strlen(dot);        // e.g. ".md" = 3
+    size_t baseLen = 32 - extLen;       // chars left for the base
+    if (baseLen < 1) baseLen = 1;
+    snprintf(out, outSize, "%.*s%s", (int)baseLen, in, dot);
+  } else {
+    snprintf(out, outSize, "%.32s", in);
+  }
+}
+
 size_t istoreTotalBytes() {
   if (!ready) return 0;
   return LittleFS.totalBytes();
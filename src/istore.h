@@ -20,6 +20,9 @@ bool istoreExists(const char* path);
 // Wipe all files and folders from internal storage
 void istoreWipe();
 
+// Truncate a filename to 32 chars for internal storage, preserving the extension
+void istoreTruncateName(const char* in, char* out, size_t outSize);
+
 // Storage capacity
 size_t istoreTotalBytes();
 size_t istoreUsedBytes();
@@ -0,0 +1,112 @@
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include "jpg_pipe.h"
+#include "band_push.h"
+#include "modes.h"
+
+// A decoded block waiting in the ring (w = 0: end of image, with the
+// decoder's result in slot)
+struct PipeBlock {
+  int16_t x, y;
+  uint16_t w, h;
+  uint8_t slot;
+};
+
+static uint16_t* ring[PIPE_SLOTS];
+static QueueHandle_t freeQ = nullptr;   // slot numbers the decoder may fill
+static QueueHandle_t fullQ = nullptr;   // PipeBlocks for the drain, in order
+static volatile bool active = false;
+
+// The draw the decode task is working on
+static struct {
+  int32_t x, y;
+  const char* path;
+  fs::FS* fs;
+} job;
+
+bool pipeInit() {
+  if (freeQ) return true;
+  for (int i = 0; i < PIPE_SLOTS; i++) {
+    if (!ring[i]) ring[i] = (uint16_t*)heap_caps_malloc(PIPE_BLOCK_PIXELS * sizeof(uint16_t), MALLOC_CAP_DMA);
+    if (!ring[i]) {
+      Serial.println("pipe: no DMA-capable memory for the block ring");
+      return false;
+    }
+  }
+  if (!bandPushInit()) return false;   // attaches DMA
+  freeQ = xQueueCreate(PIPE_SLOTS, sizeof(uint8_t));
+  fullQ = xQueueCreate(PIPE_SLOTS + 1, sizeof(PipeBlock));   // + end marker
+  return freeQ && fullQ;
+}
+
+bool pipeActive() { return active; }
+
+// Runs in tft_output on the decode task
+bool pipeBlock(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint16_t* bitmap) {
+  // Slots hold a resampled band or a 16x16 MCU; anything larger is a
+  // decoder or resampler change, and the slots would need to grow with it.
+  // Stop the decode rather than crop.
+  if ((uint32_t)w * h > PIPE_BLOCK_PIXELS) {
+    Serial.printf("pipe: %ux%u block does not fit a %d-pixel slot\n", w, h, PIPE_BLOCK_PIXELS);
+    return false;
+  }
+  uint8_t slot;
+  xQueueReceive(freeQ, &slot, portMAX_DELAY);
+  memcpy(ring[slot], bitmap, (size_t)w * h * sizeof(uint16_t));
+  PipeBlock b = {x, y, w, h, slot};
+  xQueueSend(fullQ, &b, portMAX_DELAY);
+  return true;
+}
+
+static void decodeTask(void*) {
+  JRESULT res = TJpgDec.drawFsJpg(job.x, job.y, job.path, *job.fs);
+  PipeBlock end = {0, 0, 0, 0, (uint8_t)res};
+  xQueueSend(fullQ, &end, portMAX_DELAY);
+  vTaskDelete(nullptr);
+}
+
+JRESULT pipeDrawFsJpg(int32_t x, int32_t y, const char* path, fs::FS& fs) {
+  for (uint8_t i = 0; i < PIPE_SLOTS; i++) xQueueSend(freeQ, &i, 0);
+  job = {x, y, path, &fs};
+  active = true;
+  // Core 0; this task drains on core 1
+  if (xTaskCreatePinnedToCore(decodeTask, "jpgdecode", 6144, nullptr, 2, nullptr, 0) != pdPASS) {
+    active = false;
+    for (uint8_t i; xQueueReceive(freeQ, &i, 0) == pdPASS;) {}
+    return JDR_MEM1;
+  }
+
+  // pushImageDMA swaps in place when swapBytes is set; blocks are already
+  // in wire order
+  bool swap = tft.getSwapBytes();
+  tft.setSwapBytes(false);
+  tft.startWrite();
+  int sending = -1;   // slot whose DMA may still be running
+  JRESULT res = JDR_INTR;
+  PipeBlock b;
+  while (xQueueReceive(fullQ, &b, portMAX_DELAY) == pdPASS) {
+    if (b.w == 0) {
+      res = (JRESULT)b.slot;
+      break;
+    }
+    // Waits for the previous block's DMA before starting this one, which
+    // frees the previous block's buffer
+    tft.pushImageDMA(b.x, b.y, b.w, b.h, ring[b.slot]);
+    if (sending >= 0) {
+      uint8_t done = (uint8_t)sending;
+      xQueueSend(freeQ, &done, 0);
+    }
+    sending = b.slot;
+  }
+  tft.dmaWait();
+  tft.endWrite();
+  tft.setSwapBytes(swap);
+  active = false;
+
+  // Leave the ring empty for the next draw
+  for (uint8_t i; xQueueReceive(freeQ, &i, 0) == pdPASS;) {}
+  return res;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <FS.h>
+#include <TJpg_Decoder.h>
+
+// ============================================================
+// Pipelined JPEG drawing.  Drawing straight from the decoder makes decode
+// and SPI transfer take turns: each MCU block is decoded, then pushed,
+// then the next is decoded.  Here a task on core 0 runs the decoder and
+// tft_output only copies each block into a ring of DMA-capable block
+// buffers; the calling task (loop(), core 1) drains the ring to the panel
+// with DMA.  A photo then takes about as long as the slower of the two.
+// ============================================================
+
+#define PIPE_SLOTS        8           // block buffers in the ring
+#define PIPE_BLOCK_PIXELS (240 * 4)   // a band of resampled rows (see
+                                      // resample.h), or a 16x16 MCU
+
+// Allocate the ring and attach the panel's DMA channel.  Safe to call
+// again.  Returns false if either failed; draw with TJpgDec directly then.
+bool pipeInit();
+
+// Decode path and draw it at (x, y) through the pipeline, returning the
+// decoder's result (JDR_INTR when the image ran off the bottom of the
+// panel).  Blocks until the last block has been sent.  Call pipeInit()
+// first, and not while anything else is using TJpgDec.
+JRESULT pipeDrawFsJpg(int32_t x, int32_t y, const char* path, fs::FS& fs);
+
+// For tft_output: true while a pipelined draw is decoding, and the sink
+// that queues a decoded block (waiting for a free buffer if need be).  A
+// block larger than PIPE_BLOCK_PIXELS stops the decode.
+bool pipeActive();
+bool pipeBlock(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint16_t* bitmap);
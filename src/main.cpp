@@ -1,24 +1,57 @@
 #include <Arduino.h>
 #include <SPI.h>
-#include <Preferences.h>
 #include <TFT_eSPI.h>
 #include <TJpg_Decoder.h>
 #include "pins.h"
 #include "modes.h"
 #include "sdcard.h"
 #include "istore.h"
+#include "frame_sched.h"
+#include "input.h"
+#include "power.h"
+#include "arena.h"
+#include "state.h"
+#include "jpg_pipe.h"
+#include "downscale.h"
+#include "resample.h"
 
 TFT_eSPI tft = TFT_eSPI();
 bool coldStart = false;
-static Preferences modePrefs;
 
-// --- TJpg_Decoder callback: render decoded JPEG blocks to TFT ---
-bool tft_output(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t* bitmap) {
+uint16_t* jpgFrame = nullptr;
+
+// Decoded (or resampled) block to the panel, jpgFrame or the pipeline's
+// block ring
+static bool panelBlock(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t* bitmap) {
   if (y >= tft.height()) return 0;
+  if (jpgFrame) {
+    // Clip the block to the frame; images larger than the panel are centered
+    int x0 = x < 0 ? -x : 0, x1 = x + w > 240 ? 240 - x : w;
+    int y0 = y < 0 ? -y : 0;
+    for (int row = y0; row < h && y + row < 240; row++) {
+      if (x1 > x0) memcpy(jpgFrame + (y + row) * 240 + x + x0, bitmap + row * w + x0, (x1 - x0) * 2);
+    }
+    return 1;
+  }
+  if (pipeActive()) return pipeBlock(x, y, w, h, bitmap);
   tft.pushImage(x, y, w, h, bitmap);
   return 1;
 }
 
+// The resampler's bands go to panelBlock() and so into pipe slots
+static_assert(RESAMPLE_SIZE * RESAMPLE_OUT_ROWS <= PIPE_BLOCK_PIXELS, "a resampled band must fit a pipe slot");
+static_assert(16 * 16 <= PIPE_BLOCK_PIXELS, "an MCU must fit a pipe slot");
+
+// --- TJpg_Decoder callback: decoded JPEG blocks to Intake's downscaler, the
+// resampler or straight to panelBlock() ---
+bool tft_output(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t* bitmap) {
+  // Intake decodes whole photos, well past the bottom of the panel
+  if (downscaleActive()) return downscaleBlock(x, y, w, h, bitmap);
+  if (jpgCancel) return 0;
+  if (resampleActive()) return resampleBlock(x, y, w, h, bitmap, panelBlock);
+  return panelBlock(x, y, w, h, bitmap);
+}
+
 // --- Mode declarations (defined in mode_*.cpp files) ---
 extern const Mode counterMode;
 extern const Mode orbitsMode;
@@ -31,98 +64,103 @@ const int modeCount = sizeof(modes) / sizeof(modes[0]);
 
 static int currentMode = 0;
 
-// --- Button state tracking for long/short press detection ---
-#define LONG_PRESS_MS 500
-
-struct ButtonState {
-  int pin;
-  bool wasPressed;
-  bool longFired;      // true if long press already triggered while held
-  unsigned long pressStart;
-};
+// Mode name overlay: shown for OVERLAY_MS after a switch while the next
+// mode prepares; input keeps flowing, and enter() runs when it ends
+#define OVERLAY_MS 400
+static bool overlayShowing = false;
+static unsigned long overlayUntil = 0;
 
-static ButtonState btn1 = {BTN1_PIN, false, false, 0};
-static ButtonState btn2 = {BTN2_PIN, false, false, 0};
+// Largest arena each mode has used on any visit
+static size_t arenaPeak[sizeof(modes) / sizeof(modes[0])];
 
 static bool modeAvailable(int idx) {
-  // Intake mode requires SD card
-  if (strcmp(modes[idx].name, "Intake") == 0 && !sdIsReady()) return false;
+  // Intake mode requires SD card (the first time, waits for the mount)
+  if (strcmp(modes[idx].name, "Intake") == 0 && !sdWait()) return false;
   return true;
 }
 
+// Leave the current mode: its exit hook, then everything in its arena
+static void exitMode() {
+  const Mode& m = modes[currentMode];
+  if (m.frameHz && !overlayShowing) {
+    Serial.printf("%s: %lu frames, %lu missed deadlines\n", m.name,
+                  (unsigned long)schedFrames(), (unsigned long)schedMissed());
+  }
+  if (m.exit) m.exit();
+  size_t internal = arenaInternal();
+  size_t peak = arenaRelease();
+  if (peak > arenaPeak[currentMode]) arenaPeak[currentMode] = peak;
+  Serial.printf("%s: arena %u bytes this visit (%u from SRAM), high-water %u\n", m.name,
+                (unsigned)peak, (unsigned)internal, (unsigned)arenaPeak[currentMode]);
+}
+
 static void switchMode(int delta) {
+  exitMode();
+
   int next = currentMode;
   for (int i = 0; i < modeCount; i++) {
     next = (next + delta + modeCount) % modeCount;
     if (modeAvailable(next)) break;
   }
   currentMode = next;
-  modePrefs.begin("mode", false);
-  modePrefs.putInt("idx", currentMode);
-  modePrefs.end();
+  stateSetInt("mode", "idx", currentMode);
   Serial.printf("Mode switched to: %s (%d/%d)\n", modes[currentMode].name, currentMode + 1, modeCount);
 
-  // Show brief mode name overlay
+  // Show brief mode name overlay, and prepare the mode behind it
+  unsigned long shownMs = millis();
   tft.fillScreen(TFT_BLACK);
   tft.setTextColor(TFT_WHITE, TFT_BLACK);
   tft.setTextDatum(MC_DATUM);
   tft.setTextFont(4);
   tft.drawString(modes[currentMode].name, 120, 120);
-  delay(400);
 
+  if (modes[currentMode].prepare) {
+    modes[currentMode].prepare();
+    Serial.printf("%s: prepared in %lu ms\n", modes[currentMode].name, millis() - shownMs);
+  }
+  overlayShowing = true;
+  overlayUntil = shownMs + OVERLAY_MS;
+  schedStart(0);   // poll input until the overlay ends
+}
+
+// Overlay over: show the prepared mode
+static void finishSwitch() {
+  overlayShowing = false;
   modes[currentMode].enter();
+  schedStart(modes[currentMode].frameHz);
 }
 
-// Returns: 0 = no event, 1 = short press (on release), 2 = long press (while held)
-static int checkButton(ButtonState& bs) {
-  bool pressed = (digitalRead(bs.pin) == LOW);
-
-  if (pressed && !bs.wasPressed) {
-    // Just pressed — start timing (with debounce)
-    delay(30);
-    if (digitalRead(bs.pin) == LOW) {
-      bs.wasPressed = true;
-      bs.longFired = false;
-      bs.pressStart = millis();
-    }
-  } else if (pressed && bs.wasPressed && !bs.longFired) {
-    // Still held — check if threshold reached
-    if (millis() - bs.pressStart >= LONG_PRESS_MS) {
-      bs.longFired = true;
-      return 2;
-    }
-  } else if (!pressed && bs.wasPressed) {
-    // Released
-    bs.wasPressed = false;
-    if (!bs.longFired) return 1; // short press
-    // long press already fired — ignore release
-  }
+// Boot timeline over serial: time since reset and since the previous phase
+static unsigned long bootLastMs = 0;
 
-  return 0;
+static void bootMark(const char* phase) {
+  unsigned long now = millis();
+  Serial.printf("Boot: %-12s at %4lu ms (+%lu)\n", phase, now, now - bootLastMs);
+  bootLastMs = now;
 }
 
 void setup() {
+  // No wait for a serial monitor: the first picture comes first
   Serial.begin(115200);
-  delay(500);
   Serial.println();
   Serial.println("=== ESP32 Round TFT Boot ===");
+  bootMark("serial");
 
-  // Enable backlight
-  pinMode(TFT_BL, OUTPUT);
-  digitalWrite(TFT_BL, HIGH);
+  // Enable backlight (PWM) and battery monitoring
+  powerInit();
   Serial.println("Backlight ON (GPIO 32)");
+  bootMark("power");
 
   // Initialize TFT
   tft.init();
   tft.setRotation(0);
   Serial.println("TFT initialized (GC9A01, 240x240)");
+  bootMark("tft");
 
-  // Initialize SD card (shares HSPI bus via tft.getSPIinstance())
-  if (sdInit()) {
-    Serial.println("SD card ready");
-  } else {
-    Serial.println("SD card not available (continuing without)");
-  }
+  // SD card (shares HSPI bus via tft.getSPIinstance()) mounts in the
+  // background; only Intake waits for it
+  sdMountAsync();
+  bootMark("sd started");
 
   // Initialize internal storage (LittleFS)
   if (istoreInit()) {
@@ -130,6 +168,7 @@ void setup() {
   } else {
     Serial.println("Internal storage failed (continuing without)");
   }
+  bootMark("littlefs");
 
   // Initialize JPEG decoder
   TJpgDec.setJpgScale(1);
@@ -137,14 +176,11 @@ void setup() {
   TJpgDec.setCallback(tft_output);
 
   // Setup buttons
-  pinMode(BTN1_PIN, INPUT_PULLUP);
-  pinMode(BTN2_PIN, INPUT_PULLUP);
+  inputInit();
   Serial.println("Buttons configured (bottom=GPIO4, top=GPIO19)");
 
   // Restore saved mode (clamped to valid range, skip unavailable)
-  modePrefs.begin("mode", true);
-  currentMode = modePrefs.getInt("idx", 0);
-  modePrefs.end();
+  currentMode = stateGetInt("mode", "idx", 0);
   if (currentMode >= modeCount) currentMode = 0;
   bool restored = modeAvailable(currentMode);
   if (!restored) currentMode = 0;
@@ -153,35 +189,56 @@ void setup() {
   // only when we actually restored the same mode (display RAM matches).
   coldStart = restored;
   Serial.printf("Starting mode: %s (%d/%d)\n", modes[currentMode].name, currentMode + 1, modeCount);
+  if (modes[currentMode].prepare) modes[currentMode].prepare();
   modes[currentMode].enter();
   coldStart = false;
+  bootMark("first frame");
+  schedStart(modes[currentMode].frameHz);
 }
 
 void loop() {
-  // Check buttons for short/long press
-  int b1 = checkButton(btn1);
-  int b2 = checkButton(btn2);
-
-  if (b1 == 2) {
-    // Bottom long press — previous mode
-    switchMode(-1);
-  } else if (b1 == 1) {
-    // Bottom short press — forward to mode
-    Serial.println("Bottom button short press");
-    modes[currentMode].onButton(1);
+  // Battery sample and governor retune, every few seconds
+  powerPoll();
+  // Saved positions go to flash once they stop changing
+  statePoll();
+
+  // Handle every press captured since the last frame, in order
+  ButtonEvent ev;
+  while (inputNext(ev)) {
+    if (ev.kind == BTN_LONG) {
+      // Long press — bottom: previous mode, top: next mode
+      switchMode(ev.btn == 1 ? -1 : 1);
+    } else if (!overlayShowing) {
+      // Short press — forward to mode (not yet entered while the overlay shows)
+      Serial.println(ev.btn == 1 ? "Bottom button short press" : "Top button short press");
+      modes[currentMode].onButton(ev.btn);
+    }
   }
 
-  if (b2 == 2) {
-    // Top long press — next mode
-    switchMode(1);
-  } else if (b2 == 1) {
-    // Top short press — forward to mode
-    Serial.println("Top button short press");
-    modes[currentMode].onButton(2);
+  if (overlayShowing) {
+    if ((long)(millis() - overlayUntil) < 0) {
+      schedFrameDt();
+      schedSleep();
+      return;
+    }
+    finishSwitch();
   }
 
-  // Let current mode update (for animations)
-  modes[currentMode].update();
-
-  delay(16); // ~60fps tick
+  // Let current mode update (for animations) with the real frame time
+  const Mode& m = modes[currentMode];
+  uint32_t dtUs = schedFrameDt();
+  bool idle = m.isIdle ? m.isIdle() : !m.frameHz;
+  if (!idle && m.frameHz) m.update(dtUs);
+
+  if (idle && inputQuiet() && !sdMounting()) {
+    // Nothing to animate, no press in progress and no card mount in
+    // flight (sleep stops both cores): light-sleep until a button goes
+    // down, or until unsaved state is due so statePoll() can write it.
+    // The panel keeps its GRAM, so the picture stays.
+    inputLightSleep(stateQuietLeftMs());
+    schedResync();
+  } else {
+    // Sleep out the rest of the frame period
+    schedSleep();
+  }
 }
@@ -51,14 +51,10 @@ static void counterEnter() {
   drawUI();
 }
 
-static void counterUpdate() {
-  // Static display — nothing to animate
-}
-
 static void counterButton(int btn) {
   if (btn == 1) pressCount1++;
   else if (btn == 2) pressCount2++;
   drawUI();
 }
 
-extern const Mode counterMode = {"Counter", counterEnter, counterUpdate, counterButton};
+extern const Mode counterMode = {"Counter", nullptr, counterEnter, nullptr, nullptr, counterButton, 0, nullptr};
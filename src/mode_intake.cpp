@@ -4,6 +4,8 @@
 #include "modes.h"
 #include "sdcard.h"
 #include "istore.h"
+#include "poem_layout.h"
+#include "downscale.h"
 
 #define COPY_BUF_SIZE 4096
 #define MAX_FOLDERS 16
@@ -122,22 +124,28 @@ static void drawResult() {
   }
 }
 
-// Truncate a filename to 32 chars, preserving the extension
-static void truncateName(const char* in, char* out, size_t outSize) {
-  size_t len = strlen(in);
-  if (len <= 32) {
-    strncpy(out, in, outSize);
-    out[outSize - 1] = '\0';
-    return;
-  }
-  const char* dot = strrchr(in, '.');
-  if (dot) {
-    size_t extLen = strlen(dot);        // e.g. ".md" = 3
-    size_t baseLen = 32 - extLen;       // chars left for the base
-    if (baseLen < 1) baseLen = 1;
-    snprintf(out, outSize, "%.*s%s", (int)baseLen, in, dot);
-  } else {
-    snprintf(out, outSize, "%.32s", in);
+// Where the copy time goes, for the throughput report
+static uint32_t bytesCopied = 0;
+static uint32_t sdReadUs = 0;
+static uint32_t flashWriteUs = 0;
+static int photosScaled = 0;
+static uint32_t scaledInBytes = 0;    // JPEG bytes on the card
+static uint32_t scaledOutBytes = 0;   // Q565 bytes in flash
+static uint32_t scaleMs = 0;
+
+static uint32_t kbPerSec(uint32_t bytes, uint32_t us) {
+  return us ? (uint32_t)((uint64_t)bytes * 1000000 / 1024 / us) : 0;
+}
+
+static void reportThroughput(uint32_t totalMs) {
+  Serial.printf("Intake: %u KB in %u ms, SD at %u MHz: read %u ms (%u KB/s), "
+                "flash write %u ms (%u KB/s)\n",
+    (unsigned)(bytesCopied / 1024), (unsigned)totalMs, (unsigned)(sdClockHz() / 1000000),
+    (unsigned)(sdReadUs / 1000), (unsigned)kbPerSec(bytesCopied, sdReadUs),
+    (unsigned)(flashWriteUs / 1000), (unsigned)kbPerSec(bytesCopied, flashWriteUs));
+  if (photosScaled) {
+    Serial.printf("Intake: %d photos downscaled in %u ms, %u KB -> %u KB\n", photosScaled,
+      (unsigned)scaleMs, (unsigned)(scaledInBytes / 1024), (unsigned)(scaledOutBytes / 1024));
   }
 }
 
@@ -160,10 +168,15 @@ static bool copyFile(const char* srcPath, const char* dstPath) {
   bool success = true;
 
   while (src.available()) {
+    unsigned long t0 = micros();
     size_t bytesRead = src.read(buf, COPY_BUF_SIZE);
+    unsigned long t1 = micros();
+    sdReadUs += t1 - t0;
     if (bytesRead == 0) break;
 
     size_t bytesWritten = dst.write(buf, bytesRead);
+    flashWriteUs += micros() - t1;
+    bytesCopied += bytesWritten;
     if (bytesWritten != bytesRead) {
       Serial.printf("Intake: write failed at %u bytes (disk full?)\n",
         (unsigned)totalWritten);
@@ -184,6 +197,31 @@ static bool copyFile(const char* srcPath, const char* dstPath) {
   return success;
 }
 
+// name.jpg -> name.q565
+static void nativeName(const char* name, char* out, size_t outSize) {
+  const char* dot = strrchr(name, '.');
+  int stem = dot ? dot - name : strlen(name);
+  snprintf(out, outSize, "%.*s.q565", stem, name);
+}
+
+// Store a photo larger than the panel as a panel-sized Q565 instead of
+// copying it
+static bool downscaleFile(const char* srcPath, const char* dstPath, uint32_t srcSize) {
+  unsigned long t0 = millis();
+  if (!downscaleJpeg(srcPath, SD, dstPath, LittleFS)) return false;
+  uint32_t ms = millis() - t0;
+  File f = LittleFS.open(dstPath, FILE_READ);
+  uint32_t outSize = f ? f.size() : 0;
+  f.close();
+  photosScaled++;
+  scaleMs += ms;
+  scaledInBytes += srcSize;
+  scaledOutBytes += outSize;
+  Serial.printf("Intake: downscaled %s (%u -> %u bytes, %u ms)\n", dstPath,
+    (unsigned)srcSize, (unsigned)outSize, (unsigned)ms);
+  return true;
+}
+
 // Count total files across all folders for progress display
 static int countFiles(char folders[][64], int folderCount) {
   int total = 0;
@@ -205,8 +243,14 @@ static void runIntake() {
   filesCopied = 0;
   filesTotal = 0;
   foldersFound = 0;
-
-  if (!sdIsReady()) {
+  bytesCopied = 0;
+  sdReadUs = 0;
+  flashWriteUs = 0;
+  photosScaled = 0;
+  scaledInBytes = scaledOutBytes = 0;
+  scaleMs = 0;
+
+  if (!sdWait()) {
     intakeState = INTAKE_NO_SD;
     drawResult();
     return;
@@ -252,12 +296,20 @@ static void runIntake() {
     return;
   }
 
+  // A card not seen before is still at the safe clock
+  drawProgress(0, filesTotal, "Checking card...");
+  sdStepUp();
+
+  bool scaling = downscaleBegin();
+  if (!scaling) Serial.println("Intake: no memory to downscale photos, copying them as is");
+
   // Wipe LittleFS before mirroring
   Serial.println("Intake: wiping internal storage...");
   drawProgress(0, filesTotal, "Wiping storage...");
   istoreWipe();
 
   // Copy each folder and its files
+  unsigned long copyStartMs = millis();
   bool anyError = false;
   int progressIndex = 0;
 
@@ -284,7 +336,20 @@ static void runIntake() {
       char dstPath[128];
       char shortName[33];
       snprintf(srcPath, sizeof(srcPath), "%s/%s", sdFolder, items.items[i].name);
-      truncateName(items.items[i].name, shortName, sizeof(shortName));
+
+      if (scaling && items.items[i].type == SD_ITEM_JPEG && downscaleWanted(srcPath, SD)) {
+        char native[72];
+        nativeName(items.items[i].name, native, sizeof(native));
+        istoreTruncateName(native, shortName, sizeof(shortName));
+        snprintf(dstPath, sizeof(dstPath), "%s/%s", iFolder, shortName);
+        if (downscaleFile(srcPath, dstPath, items.items[i].size)) {
+          filesCopied++;
+          continue;
+        }
+        Serial.printf("Intake: cannot downscale %s, copying it as is\n", srcPath);
+      }
+
+      istoreTruncateName(items.items[i].name, shortName, sizeof(shortName));
       snprintf(dstPath, sizeof(dstPath), "%s/%s", iFolder, shortName);
 
       // Check free space
@@ -297,12 +362,14 @@ static void runIntake() {
 
       if (copyFile(srcPath, dstPath)) {
         filesCopied++;
+        if (items.items[i].type == SD_ITEM_MARKDOWN) buildPoemCache(dstPath);
       } else {
         anyError = true;
       }
     }
   }
 
+  reportThroughput(millis() - copyStartMs);
   intakeState = anyError ? INTAKE_ERROR : INTAKE_DONE;
   drawResult();
 }
@@ -311,8 +378,8 @@ static void intakeEnter() {
   runIntake();
 }
 
-static void intakeUpdate() {
-  // Static display — nothing to animate
+static void intakeExit() {
+  downscaleEnd();   // its buffers go with the arena
 }
 
 static void intakeButton(int btn) {
@@ -322,4 +389,4 @@ static void intakeButton(int btn) {
   }
 }
 
-extern const Mode intakeMode = {"Intake", intakeEnter, intakeUpdate, intakeButton};
+extern const Mode intakeMode = {"Intake", nullptr, intakeEnter, intakeExit, nullptr, intakeButton, 0, nullptr};
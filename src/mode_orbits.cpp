@@ -9,6 +9,9 @@
 #define INITIAL_ORBITERS 3
 #define DOT_RADIUS 5
 
+// Frame rate; orbiter speeds are per frame at this rate
+#define ORBITS_HZ 60
+
 static const uint16_t palette[] = {
   TFT_RED, TFT_GREEN, TFT_CYAN, TFT_MAGENTA,
   TFT_YELLOW, TFT_ORANGE, TFT_PINK, TFT_WHITE
@@ -16,7 +19,7 @@ static const uint16_t palette[] = {
 
 struct Orbiter {
   float angle;     // current angle in radians
-  float speed;     // radians per frame
+  float speed;     // radians per 1/ORBITS_HZ s
   float radius;    // orbit radius from center
   uint16_t color;
   int16_t prevX, prevY; // previous drawn position for erasure
@@ -53,8 +56,9 @@ static void orbitsEnter() {
   }
 }
 
-static void orbitsUpdate() {
+static void orbitsUpdate(uint32_t dtUs) {
   if (paused) return;
+  float steps = dtUs * (ORBITS_HZ / 1000000.0f);
 
   for (int i = 0; i < numOrbiters; i++) {
     Orbiter& o = orbiters[i];
@@ -67,7 +71,7 @@ static void orbitsUpdate() {
     }
 
     // Advance angle
-    o.angle += o.speed;
+    o.angle += o.speed * steps;
     if (o.angle > TWO_PI) o.angle -= TWO_PI;
 
     // Compute new position
@@ -85,6 +89,8 @@ static void orbitsUpdate() {
   tft.fillCircle(CENTER_X, CENTER_Y, 2, TFT_DARKGREY);
 }
 
+static bool orbitsIdle() { return paused; }
+
 static void orbitsButton(int btn) {
   if (btn == 1) {
     // Bottom button: add/remove orbiter
@@ -109,4 +115,4 @@ static void orbitsButton(int btn) {
   }
 }
 
-extern const Mode orbitsMode = {"Orbits", orbitsEnter, orbitsUpdate, orbitsButton};
+extern const Mode orbitsMode = {"Orbits", nullptr, orbitsEnter, nullptr, orbitsUpdate, orbitsButton, ORBITS_HZ, orbitsIdle};
@@ -1,16 +1,21 @@
 #include <Arduino.h>
 #include <LittleFS.h>
-#include <Preferences.h>
 #include <TJpg_Decoder.h>
 #include "modes.h"
 #include "istore.h"
-
-static Preferences prefs;
+#include "arena.h"
+#include "band_push.h"
+#include "state.h"
+#include "prefetch.h"
+#include "jpg_pipe.h"
+#include "q565.h"
+#include "resample.h"
 
 #define US_FOLDER "/us"
 #define MAX_IMAGES 32
 
-static char imagePaths[MAX_IMAGES][80];
+typedef char ImagePath[80];
+static ImagePath* imagePaths = nullptr;   // MAX_IMAGES, in the mode arena
 static int imageCount = 0;
 static int currentImage = 0;
 
@@ -23,6 +28,34 @@ static void showError(const char* line1, const char* line2) {
   if (line2) tft.drawString(line2, 120, 130);
 }
 
+// Set the decoder scale for the image and have the resampler fill the
+// panel with it.  Returns false if the JPEG header cannot be read.
+static bool beginImage(const char* path) {
+  uint16_t w = 0, h = 0;
+  TJpgDec.getFsJpgSize(&w, &h, path, LittleFS);
+  if (w == 0 || h == 0) return false;
+
+  uint16_t sw, sh;
+  TJpgDec.setJpgScale(resampleScale(w, h, sw, sh));
+  resampleBegin(sw, sh);
+  return true;
+}
+
+// Image counter overlay
+static void drawCounter() {
+  char buf[16];
+  snprintf(buf, sizeof(buf), "%d/%d", currentImage + 1, imageCount);
+  tft.setTextColor(TFT_WHITE, TFT_BLACK);
+  tft.setTextDatum(TL_DATUM);
+  tft.setTextFont(2);
+  tft.drawString(buf, 4, 4);
+}
+
+// Display-native images fill the panel and need no JPEG decoder
+static bool isNative(const char* path) {
+  return classifyFile(path) == SD_ITEM_Q565;
+}
+
 static void drawCurrentImage() {
   if (imageCount == 0) {
     showError("No images", "Run Intake first");
@@ -32,55 +65,94 @@ static void drawCurrentImage() {
   const char* path = imagePaths[currentImage];
   Serial.printf("Us: showing %d/%d: %s\n", currentImage + 1, imageCount, path);
 
-  // Get image dimensions to pick a scale factor
-  uint16_t w = 0, h = 0;
-  TJpgDec.getFsJpgSize(&w, &h, path, LittleFS);
-  if (w == 0 || h == 0) {
+  if (isNative(path)) {
+    if (!q565Draw(path, LittleFS)) {
+      showError("Failed to load", path);
+      return;
+    }
+    drawCounter();
+    return;
+  }
+
+  if (!beginImage(path)) {
     showError("Failed to load", path);
     return;
   }
 
-  uint8_t scale = 1;
-  while (scale < 8 && (w / (scale * 2) >= 240 || h / (scale * 2) >= 240)) {
-    scale *= 2;
+  // The resampled image covers the whole panel
+  if (pipeInit()) {
+    // Decode on core 0 while this core pushes the rows by DMA
+    pipeDrawFsJpg(0, 0, path, LittleFS);
+  } else {
+    // LittleFS reads from internal flash (not SPI), so no bus contention with TFT.
+    // startWrite/endWrite keeps TFT CS asserted for faster block rendering.
+    tft.startWrite();
+    TJpgDec.drawFsJpg(0, 0, path, LittleFS);
+    tft.endWrite();
   }
+  resampleEnd();
 
-  uint16_t sw = w / scale;
-  uint16_t sh = h / scale;
-  int16_t xOff = (240 - (int16_t)sw) / 2;
-  int16_t yOff = (240 - (int16_t)sh) / 2;
+  drawCounter();
+}
 
-  tft.fillScreen(TFT_BLACK);
-  TJpgDec.setJpgScale(scale);
-  // LittleFS reads from internal flash (not SPI), so no bus contention with TFT.
-  // startWrite/endWrite keeps TFT CS asserted for faster block rendering.
-  tft.startWrite();
-  TJpgDec.drawFsJpg(xOff, yOff, path, LittleFS);
-  tft.endWrite();
-
-  // Image counter overlay
-  char buf[16];
-  snprintf(buf, sizeof(buf), "%d/%d", currentImage + 1, imageCount);
-  tft.setTextColor(TFT_WHITE, TFT_BLACK);
-  tft.setTextDatum(TL_DATUM);
-  tft.setTextFont(2);
-  tft.drawString(buf, 4, 4);
+// The current image, decoded by usPrepare() while the mode name shows
+// (nullptr: not decoded, usEnter() decodes to the panel as usual)
+static uint16_t* firstFrame = nullptr;
+
+// Images decoded ahead into PSRAM frames (false without PSRAM: every
+// press decodes straight to the panel)
+static bool prefetching = false;
+
+// Direction of the last press, for which neighbour to decode first
+static int travel = 1;
+
+static bool decodeToFrame(int idx, uint16_t* frame) {
+  const char* path = imagePaths[idx];
+  if (isNative(path)) return q565DecodeFile(path, LittleFS, frame);
+
+  if (!beginImage(path)) return false;
+
+  memset(frame, 0, 240 * 240 * sizeof(uint16_t));
+  jpgFrame = frame;
+  // JDR_INTR: tft_output stopped it once the panel was full
+  JRESULT rc = TJpgDec.drawFsJpg(0, 0, path, LittleFS);
+  bool ok = rc == JDR_OK || rc == JDR_INTR;
+  jpgFrame = nullptr;
+  resampleEnd();
+  return ok;
 }
 
-static void usEnter() {
+// True if items holds a display-native copy of name (same name, .q565)
+static bool hasNativeCopy(const SDItemList& items, const char* name) {
+  const char* dot = strrchr(name, '.');
+  size_t stem = dot ? dot - name : strlen(name);
+  for (int i = 0; i < items.count; i++) {
+    const SDItem& it = items.items[i];
+    if (it.type == SD_ITEM_Q565 && strncasecmp(it.name, name, stem) == 0 && it.name[stem] == '.') {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Listing, saved index and the first decode; nothing is drawn
+static void usPrepare() {
   imageCount = 0;
   currentImage = 0;
+  firstFrame = nullptr;
 
-  if (!istoreIsReady()) {
-    showError("Storage not", "available");
-    return;
-  }
+  if (!istoreIsReady()) return;
+  imagePaths = arenaNew<ImagePath>(MAX_IMAGES);
+  if (!imagePaths) return;
 
   SDItemList items = istoreGetItems(US_FOLDER);
   for (int i = 0; i < items.count && imageCount < MAX_IMAGES; i++) {
     // Skip dotfiles
     if (items.items[i].name[0] == '.') continue;
-    if (items.items[i].type == SD_ITEM_JPEG) {
+    // A JPEG with a .q565 beside it is shown from the .q565
+    SDItemType type = items.items[i].type;
+    if (type == SD_ITEM_Q565 ||
+        (type == SD_ITEM_JPEG && !hasNativeCopy(items, items.items[i].name))) {
       snprintf(imagePaths[imageCount], sizeof(imagePaths[imageCount]),
                "%s/%s", US_FOLDER, items.items[i].name);
       imageCount++;
@@ -88,35 +160,97 @@ static void usEnter() {
   }
 
   // Restore saved image index (clamped to valid range)
-  prefs.begin("us", true);  // read-only
-  currentImage = prefs.getInt("idx", 0);
-  prefs.end();
+  currentImage = stateGetInt("us", "idx", 0);
   if (currentImage >= imageCount) currentImage = 0;
 
   Serial.printf("Us: found %d images, resuming at %d\n", imageCount, currentImage + 1);
 
+  if (imageCount == 0) return;
+  travel = 1;
+  prefetching = psramFound() && prefetchBegin(imageCount, decodeToFrame);
+  if (prefetching) prefetchAround(currentImage, travel);
+
+  // On cold start the panel already shows it; otherwise decode it now
+  if (coldStart) return;
+  if (prefetching) {
+    firstFrame = prefetchWait(currentImage);
+  } else {
+    uint16_t* frame = arenaNew<uint16_t>(240 * 240);
+    if (frame && decodeToFrame(currentImage, frame)) firstFrame = frame;
+  }
+}
+
+static void pushFrame(uint16_t* frame) {
+  if (bandPushInit()) bandPush565(frame);
+  else tft.pushImage(0, 0, 240, 240, frame);
+  drawCounter();
+}
+
+static void usEnter() {
+  if (!istoreIsReady()) {
+    showError("Storage not", "available");
+    return;
+  }
+  if (!imagePaths) {
+    showError("Out of memory", nullptr);
+    return;
+  }
+
   // On cold start the display already shows the correct image from before
   // reboot (GC9A01 GRAM persists while power is maintained). Skip the redraw.
-  if (!coldStart) {
+  if (coldStart) return;
+
+  if (firstFrame) {
+    Serial.printf("Us: showing %d/%d: %s (decoded ahead)\n", currentImage + 1, imageCount,
+                  imagePaths[currentImage]);
+    pushFrame(firstFrame);
+  } else if (prefetching) {
+    showError("Failed to load", imagePaths[currentImage]);
+  } else {
     drawCurrentImage();
   }
 }
 
-static void usUpdate() {
-  // Static display
+// Light sleep would stall the prefetch task too; hold off while it works
+static bool usIdle() {
+  return !prefetching || !prefetchBusy();
+}
+
+static void usExit() {
+  if (prefetching) {
+    prefetchEnd();
+    Serial.printf("Us: prefetch %lu hits, %lu misses\n",
+                  (unsigned long)prefetchHits(), (unsigned long)prefetchMisses());
+    prefetching = false;
+  }
+  imagePaths = nullptr;   // all released with the arena
+  firstFrame = nullptr;
+  imageCount = 0;
 }
 
 static void usButton(int btn) {
   if (imageCount == 0) return;
   if (btn == 1) {
+    travel = 1;
     currentImage = (currentImage + 1) % imageCount;
   } else if (btn == 2) {
+    travel = -1;
     currentImage = (currentImage - 1 + imageCount) % imageCount;
   }
-  prefs.begin("us", false);
-  prefs.putInt("idx", currentImage);
-  prefs.end();
-  drawCurrentImage();
+  stateSetInt("us", "idx", currentImage);
+  if (!prefetching) {
+    drawCurrentImage();
+    return;
+  }
+
+  // The decoder belongs to the prefetch task now: a miss waits for it
+  uint16_t* frame = prefetchGet(currentImage, travel);
+  if (!frame) {
+    showError("Failed to load", imagePaths[currentImage]);
+    return;
+  }
+  Serial.printf("Us: showing %d/%d: %s\n", currentImage + 1, imageCount, imagePaths[currentImage]);
+  pushFrame(frame);
 }
 
-extern const Mode usMode = {"Us", usEnter, usUpdate, usButton};
+extern const Mode usMode = {"Us", usPrepare, usEnter, usExit, nullptr, usButton, 0, usIdle};
@@ -5,14 +5,28 @@
 // Mode interface — each display mode implements these callbacks
 struct Mode {
   const char* name;
-  void (*enter)();           // called when switching to this mode
-  void (*update)();          // called every loop iteration
+  void (*prepare)();         // optional: heavy setup (listing, loading) run while the
+                             // mode-name overlay shows; must not draw
+  void (*enter)();           // called when switching to this mode (after prepare)
+  void (*exit)();            // optional: called when leaving, before the mode arena is released
+  void (*update)(uint32_t dtUs); // called once per frame with the time since the last one
   void (*onButton)(int btn); // called on short press (1=bottom, 2=top)
+  uint16_t frameHz;          // target frame rate; 0 = static (update is never called)
+  bool (*isIdle)();          // optional: true while there is nothing to animate (static
+                             // modes: no background work), so loop() may light-sleep
 };
 
 // Shared TFT instance (owned by main.cpp)
 extern TFT_eSPI tft;
 
+// When set, JPEG decodes land in this 240x240 frame (RGB565 in SPI byte
+// order, as the panel would receive them) instead of on the panel
+extern uint16_t* jpgFrame;
+
+// Set to abandon the JPEG decode in progress (tft_output stops it at the
+// next block); owned by the image prefetcher
+extern volatile bool jpgCancel;
+
 // True during the very first enter() call after boot — lets modes skip
 // redundant drawing when the display already shows the correct content.
 extern bool coldStart;
@@ -0,0 +1,583 @@
+#include <LittleFS.h>
+#include "poem_layout.h"
+#include "modes.h"
+#include "istore.h"
+
+static PoemLine* addLine(PoemLayout& L, const char* text, int len, LineType type, uint32_t pos) {
+  if (L.count - L.first >= POEM_RING) return nullptr;
+  if (len >= MAX_DLINE_LEN) len = MAX_DLINE_LEN - 1;
+  if (type != LINE_TITLE && !L.pastTitle) {
+    L.nextY += TITLE_BODY_GAP;
+    L.pastTitle = true;
+  }
+  PoemLine& ln = poemLine(L, L.count);
+  memcpy(ln.text, text, len);
+  ln.text[len] = '\0';
+  ln.run[0] = {0, (uint8_t)len, 0};
+  ln.runs = len ? 1 : 0;
+  ln.quote = false;
+  ln.type = type;
+  ln.pos = pos;
+  ln.y = L.nextY;
+  L.nextY += lineHeight(type);
+  L.count++;
+  return &ln;
+}
+
+// Pixel width of a line as drawPoemLine() renders it (bold runs are
+// double-struck one pixel to the right)
+static int16_t measureLine(const PoemLine& ln) {
+  if (ln.type == LINE_TITLE) return tft.textWidth(ln.text, 4);
+  int w = ln.quote ? QUOTE_INDENT : 0;
+  if (ln.type == LINE_WRAP) w += 12;
+  if (ln.runs == 1 && ln.run[0].off == 0 && ln.text[ln.run[0].len] == '\0') {
+    return w + tft.textWidth(ln.text, 2) + (poemRunBold(ln, 0) ? 1 : 0);   // plain line
+  }
+  char buf[MAX_DLINE_LEN];
+  for (int r = 0; r < ln.runs; r++) {
+    poemRunText(ln, r, buf);
+    w += tft.textWidth(buf, 2) + (poemRunBold(ln, r) ? 1 : 0);
+  }
+  return w;
+}
+
+void wordWrap(PoemLayout& L, const char* text, int maxChars, LineType firstType, LineType wrapType,
+              uint32_t pos) {
+  PoemLine* ln;
+  const char* start = text;
+  if (!text || !*text) {
+    if ((ln = addLine(L, "", 0, firstType, pos))) ln->width = measureLine(*ln);
+    return;
+  }
+  bool first = true;
+  while (*text) {
+    int len = strlen(text);
+    LineType type = first ? firstType : wrapType;
+    if (len <= maxChars) {
+      if ((ln = addLine(L, text, len, type, pos + (text - start)))) ln->width = measureLine(*ln);
+      break;
+    }
+    int breakAt = maxChars;
+    while (breakAt > 0 && text[breakAt] != ' ') breakAt--;
+    if (breakAt == 0) breakAt = maxChars;
+    if ((ln = addLine(L, text, breakAt, type, pos + (text - start)))) ln->width = measureLine(*ln);
+    text += breakAt;
+    while (*text == ' ') text++;
+    first = false;
+  }
+}
+
+// --- Sliding read window ---
+
+// Enough look-ahead to decide a body wrap (a full display line of source
+// bytes plus a "\r\n" terminator) and to find the close of any '*' opened
+// on it.
+#define WRAP_LOOKAHEAD (MAX_DLINE_LEN + 2 + MARK_SCAN)
+
+// Make the window hold at least `need` bytes from the cursor (fewer only at
+// end of file).  Returns the bytes available from the cursor.
+static int fillWindow(PoemLayout& L, int need = WRAP_LOOKAHEAD) {
+  int at = L.cursor - L.winPos;
+  if (L.winLen - at >= need) return L.winLen - at;
+  memmove(L.window, L.window + at, L.winLen - at);
+  L.winPos = L.cursor;
+  L.winLen -= at;
+  if (L.file) {
+    L.winLen += L.file.read((uint8_t*)L.window + L.winLen, POEM_WINDOW - L.winLen);
+  }
+  return L.winLen;
+}
+
+static inline const char* cursorPtr(const PoemLayout& L) { return L.window + (L.cursor - L.winPos); }
+
+// Content length of the source line at the cursor if it ends within the
+// first `avail` bytes ("\r\n" counts as its terminator), -1 otherwise.
+// *consumed gets the bytes up to and including the terminator.
+static int sourceLineEnd(const char* p, int avail, int limit, int* consumed) {
+  for (int n = 0; n < avail && n <= limit; n++) {
+    if (p[n] == '\n') {
+      *consumed = n + 1;
+      return (n > 0 && p[n - 1] == '\r') ? n - 1 : n;
+    }
+  }
+  return -1;
+}
+
+void closePoem(PoemLayout& L) {
+  if (L.file) L.file.close();
+  L.file = File();
+  L.cached = false;
+  L.cacheLines = 0;
+  L.winPos = L.winLen = 0;
+  L.cursor = 0;
+  L.lineStart = true;
+  L.pastTitle = false;
+  L.kind = LINE_BODY;
+  L.quote = false;
+  L.hardBreak = false;
+  L.style = 0;
+  L.eof = true;
+  L.title[0] = '\0';
+  L.first = L.count = 0;
+  L.topPad = 0;
+  L.nextY = 0;
+  L.totalHeight = 0;
+}
+
+void openPoem(PoemLayout& L, File f) {
+  closePoem(L);
+  L.file = f;
+  L.eof = false;
+
+  // Extract title from "# " line
+  int avail = fillWindow(L, MAX_TITLE_LEN + 2);
+  const char* p = cursorPtr(L);
+  uint32_t titlePos = 0;
+  if (avail >= 2 && p[0] == '#' && p[1] == ' ') {
+    L.cursor += 2;
+    titlePos = L.cursor;
+    avail = fillWindow(L, MAX_TITLE_LEN + 1);
+    p = cursorPtr(L);
+    int consumed;
+    int len = sourceLineEnd(p, avail, avail - 1, &consumed);
+    if (len < 0) len = consumed = avail;
+    if (len > MAX_TITLE_LEN - 1) len = MAX_TITLE_LEN - 1;
+    memcpy(L.title, p, len);
+    L.title[len] = '\0';
+    L.cursor += consumed;
+
+    // Rest of an over-long title line
+    while (consumed == avail && avail > 0 && p[avail - 1] != '\n') {
+      avail = fillWindow(L);
+      p = cursorPtr(L);
+      if (sourceLineEnd(p, avail, avail - 1, &consumed) < 0) consumed = avail;
+      L.cursor += consumed;
+    }
+    while ((avail = fillWindow(L)) > 0 && (*cursorPtr(L) == '\r' || *cursorPtr(L) == '\n')) L.cursor++;
+  } else {
+    strncpy(L.title, "Untitled", sizeof(L.title));
+  }
+
+  // Title lines (wrapped at 16 chars, all centered)
+  wordWrap(L, L.title, TITLE_WRAP, LINE_TITLE, LINE_TITLE, titlePos);
+
+  int titleBlockH = L.count * TITLE_LINE_H;
+  L.topPad = (240 - titleBlockH) / 2;
+  if (L.topPad < 20) L.topPad = 20;
+  for (int n = L.first; n < L.count; n++) poemLine(L, n).y += L.topPad;
+  L.nextY += L.topPad;
+}
+
+// --- Markdown ---
+
+// Does the '*' marker of length m at p[i] open a span?  It must hug the next
+// character and be closed by a matching marker, hugging the character before
+// it, later on the same source line within MARK_SCAN bytes.
+static bool markOpens(const char* p, int i, int m, int avail) {
+  int j = i + m;
+  if (j >= avail || p[j] == ' ' || p[j] == '\r' || p[j] == '\n') return false;
+  int end = i + m + MARK_SCAN;
+  if (end > avail) end = avail;
+  for (j = i + m + 1; j < end && p[j] != '\n'; j++) {
+    if (p[j] != '*' || p[j - 1] == ' ' || p[j - 1] == '*') continue;
+    int k = 1;
+    while (j + k < avail && p[j + k] == '*') k++;
+    if (m == 2 ? k >= 2 : (k == 1 || k == 3)) return true;
+    j += k - 1;
+  }
+  return false;
+}
+
+// If p[i] starts an emphasis/bold marker, update style and return its length
+// (0 = a literal '*').  prevSolid: the preceding character is not a space.
+static int markAt(const char* p, int i, int avail, uint8_t& style, bool prevSolid) {
+  int n = 1;
+  while (n < 3 && i + n < avail && p[i + n] == '*') n++;
+  if (n >= 2) {
+    if ((style & RUN_BOLD) && prevSolid) { style &= ~RUN_BOLD; return 2; }
+    if (!(style & RUN_BOLD) && markOpens(p, i, 2, avail)) { style |= RUN_BOLD; return 2; }
+  }
+  if ((style & RUN_EMPH) && prevSolid) { style &= ~RUN_EMPH; return 1; }
+  if (!(style & RUN_EMPH) && markOpens(p, i, 1, avail)) { style |= RUN_EMPH; return 1; }
+  return 0;
+}
+
+// Body lines are wrapped at 32 visible chars exactly like wordWrap() would
+// wrap each source line, tokenizing markdown in place on the window as they
+// go: line prefixes set the line kind, '*' markers switch the style of the
+// runs that follow and take no space.
+static bool nextCachedLine(PoemLayout& L);
+
+bool nextPoemLine(PoemLayout& L) {
+  if (L.eof || L.count - L.first >= POEM_RING) return false;
+  if (L.cached) return nextCachedLine(L);
+
+  int avail, consumed;
+  for (;;) {
+    avail = fillWindow(L);
+    const char* p = cursorPtr(L);
+    if (L.lineStart) break;
+
+    // Continuing a wrapped source line: skip the spaces at the break, and
+    // move on to the next source line if nothing else is left on this one.
+    int s = 0;
+    while (s < avail && p[s] == ' ') s++;
+    L.cursor += s;
+    if (s > 0) continue;
+    if (avail == 0) break;
+    if (sourceLineEnd(p, avail, 1, &consumed) == 0) {
+      L.cursor += consumed;
+      L.lineStart = true;
+      continue;
+    }
+    break;
+  }
+
+  if (avail == 0) {
+    // End of file: bottom padding so the last line can reach center
+    L.eof = true;
+    L.totalHeight = L.nextY + 120;
+    return false;
+  }
+
+  // Line prefix: "> " blockquote, "#".."######" heading
+  const char* p = cursorPtr(L);
+  bool first = L.lineStart;
+  bool prefixed = false;
+  if (first) {
+    L.kind = LINE_BODY;
+    L.quote = false;
+    L.hardBreak = false;
+    L.style = 0;
+    int k = 0;
+    if (p[0] == '>') {
+      L.quote = true;
+      k = (avail > 1 && p[1] == ' ') ? 2 : 1;
+    } else {
+      int h = 0;
+      while (h < avail && h < 6 && p[h] == '#') h++;
+      if (h && h < avail && p[h] == ' ') {
+        L.kind = LINE_HEADING;
+        k = h + 1;
+      }
+    }
+    if (k) {
+      L.cursor += k;
+      avail = fillWindow(L);
+      p = cursorPtr(L);
+      prefixed = true;
+    }
+    L.lineStart = false;
+  }
+
+  // Scan visible characters into style runs until the source line ends or
+  // the line is full
+  int maxChars = L.quote ? QUOTE_WRAP : BODY_WRAP;
+  TextRun runs[MAX_LINE_RUNS];
+  int nRuns = 0;
+  uint8_t style = L.style;
+  int i = 0, v = 0, cut = -1;
+  int spRaw = -1, spRuns = 0, spLen = 0;   // last space at visible index >= 1
+  uint8_t spStyle = 0;
+  consumed = -1;
+  for (;;) {
+    if (i == avail) { consumed = i; break; }
+    char c = p[i];
+    if (c == '\n') { consumed = i + 1; break; }
+    if (c == '\r' && i + 1 < avail && p[i + 1] == '\n') { consumed = i + 2; break; }
+
+    bool full = i >= MAX_DLINE_LEN - 1;
+    if (!full && c == '*') {
+      bool prevSolid = i ? p[i - 1] != ' ' : (!first && L.hardBreak);
+      uint8_t st = style;
+      int m = markAt(p, i, avail, st, prevSolid);
+      if (m && i + m <= MAX_DLINE_LEN - 1) { style = st; i += m; continue; }
+      full = m != 0;     // marker does not fit: it starts the next line
+    }
+
+    if (full || v == maxChars) {
+      // Full: break at this space, else the last one, else mid-word
+      if (c == ' ' && v > 0) {
+        cut = i;
+      } else if (spRaw > 0) {
+        cut = spRaw;
+        nRuns = spRuns;
+        if (nRuns) runs[nRuns - 1].len = spLen;
+        style = spStyle;
+      } else {
+        cut = i;
+      }
+      break;
+    }
+
+    if (c == ' ' && v > 0) {
+      spRaw = i;
+      spRuns = nRuns;
+      spLen = nRuns ? runs[nRuns - 1].len : 0;
+      spStyle = style;
+    }
+    TextRun* r = nRuns ? &runs[nRuns - 1] : nullptr;
+    if (r && r->style == style && r->off + r->len == i) {
+      r->len++;
+    } else if (nRuns < MAX_LINE_RUNS) {
+      runs[nRuns++] = {(uint8_t)i, 1, style};
+    } else {
+      r->len = i + 1 - r->off;
+    }
+    i++;
+    v++;
+  }
+
+  int len = cut >= 0 ? cut : i;
+  LineType type = L.kind == LINE_HEADING ? LINE_HEADING : first ? LINE_BODY : LINE_WRAP;
+  if (first && !prefixed && len == 0 && consumed >= 0) type = LINE_STANZA;
+
+  PoemLine* ln = addLine(L, p, len, type, L.cursor);
+  if (ln) {
+    memcpy(ln->run, runs, nRuns * sizeof(TextRun));
+    ln->runs = nRuns;
+    ln->quote = L.quote;
+    ln->width = measureLine(*ln);
+  }
+
+  if (cut >= 0) {
+    L.cursor += cut;
+    L.hardBreak = p[cut] != ' ';
+    L.style = style;
+  } else {
+    L.cursor += consumed;
+    L.lineStart = true;
+  }
+  return true;
+}
+
+// --- Layout cache ---
+
+// File layout: PoemCacheHeader, then one record per display line (title
+// lines first): a PoemCacheLine, its runs, then its source bytes.  The
+// cache is self-contained, so opening a poem reads only this file, through
+// the same sliding window the .md would use.
+#define POEM_CACHE_MAGIC   0x3179614C   // "Lay1"
+#define POEM_CACHE_VERSION 3            // bump when wrapping, metrics or the format change
+
+struct PoemCacheHeader {
+  uint32_t magic;
+  uint32_t mdSize;          // .md size the cache was built from
+  uint32_t mdHash;          // and its FNV-1a hash (same-size edits)
+  uint32_t lines;
+  int32_t totalHeight;
+  int16_t topPad;
+  uint8_t version;
+  uint8_t reserved;
+  char title[MAX_TITLE_LEN];
+};
+
+struct PoemCacheLine {
+  uint32_t pos;
+  int32_t y;
+  int16_t width;
+  uint8_t len;              // source bytes that follow the runs
+  LineType type;
+  uint8_t quote;
+  uint8_t runs;             // TextRuns that follow this struct
+  uint8_t reserved[2];
+};
+
+#define POEM_CACHE_REC_MAX (int)(sizeof(PoemCacheLine) + sizeof(TextRun) * MAX_LINE_RUNS + MAX_DLINE_LEN)
+
+static_assert(sizeof(PoemCacheHeader) == 88, "cache header layout");
+static_assert(sizeof(PoemCacheLine) == 16, "cache line layout");
+static_assert(sizeof(TextRun) == 3, "cache run layout");
+static_assert(POEM_CACHE_REC_MAX <= POEM_WINDOW, "cache record must fit the window");
+
+void poemCachePath(const char* mdPath, char* out, size_t outSize) {
+  const char* slash = strrchr(mdPath, '/');
+  const char* name = slash ? slash + 1 : mdPath;
+  const char* dot = strrchr(name, '.');
+  int baseLen = dot ? (int)(dot - name) : (int)strlen(name);
+  char cacheName[MAX_TITLE_LEN];
+  char shortName[33];
+  snprintf(cacheName, sizeof(cacheName), ".%.*s.lay", baseLen, name);
+  istoreTruncateName(cacheName, shortName, sizeof(shortName));
+  snprintf(out, outSize, "%.*s%s", (int)(name - mdPath), mdPath, shortName);
+}
+
+// FNV-1a over the whole file, a 32-bit word at a time (the tail zero-
+// padded, the length mixed in); leaves the file at the start
+static uint32_t sourceHash(File& md) {
+  uint32_t buf[128];
+  uint32_t h = 2166136261u ^ (uint32_t)md.size();
+  md.seek(0);
+  int n;
+  while ((n = md.read((uint8_t*)buf, sizeof(buf))) > 0) {
+    memset((uint8_t*)buf + n, 0, (4 - (n & 3)) & 3);
+    for (int i = 0; i < (n + 3) / 4; i++) h = (h ^ buf[i]) * 16777619u;
+  }
+  md.seek(0);
+  return h;
+}
+
+static bool writeCacheLine(File& out, const PoemLine& ln) {
+  uint8_t buf[POEM_CACHE_REC_MAX];
+  PoemCacheLine rec = {};
+  rec.pos = ln.pos;
+  rec.y = ln.y;
+  rec.width = ln.width;
+  rec.len = strlen(ln.text);
+  rec.type = ln.type;
+  rec.quote = ln.quote;
+  rec.runs = ln.runs;
+  size_t n = 0;
+  memcpy(buf, &rec, sizeof(rec));
+  n += sizeof(rec);
+  memcpy(buf + n, ln.run, sizeof(TextRun) * rec.runs);
+  n += sizeof(TextRun) * rec.runs;
+  memcpy(buf + n, ln.text, rec.len);
+  n += rec.len;
+  return out.write(buf, n) == n;
+}
+
+bool buildPoemCache(const char* mdPath) {
+  static PoemLayout W;   // scratch layout, kept off the stack
+  char path[128];
+  poemCachePath(mdPath, path, sizeof(path));
+
+  File md = LittleFS.open(mdPath, "r");
+  if (!md) return false;
+  File out = LittleFS.open(path, "w");
+  if (!out) {
+    md.close();
+    return false;
+  }
+
+  unsigned long t0 = millis();
+  PoemCacheHeader h = {};
+  h.magic = POEM_CACHE_MAGIC;
+  h.version = POEM_CACHE_VERSION;
+  h.mdSize = md.size();
+  h.mdHash = sourceHash(md);
+  openPoem(W, md);
+
+  bool ok = out.write((const uint8_t*)&h, sizeof(h)) == sizeof(h);
+  while (ok) {
+    while (ok && W.first < W.count) {
+      ok = writeCacheLine(out, poemLine(W, W.first));
+      dropPoemLine(W);
+    }
+    if (!nextPoemLine(W)) break;
+  }
+
+  h.lines = W.count;
+  h.totalHeight = W.totalHeight;
+  h.topPad = W.topPad;
+  strncpy(h.title, W.title, sizeof(h.title));
+  ok = ok && W.eof && out.seek(0) && out.write((const uint8_t*)&h, sizeof(h)) == sizeof(h);
+  out.close();
+  closePoem(W);
+
+  if (!ok) {
+    LittleFS.remove(path);
+    Serial.printf("Poems: failed to write layout cache %s\n", path);
+    return false;
+  }
+  Serial.printf("Poems: cached layout %s (%u lines, %lu ms)\n", path, (unsigned)h.lines, millis() - t0);
+  return true;
+}
+
+bool openPoemCached(PoemLayout& L, File cache, const char* mdPath, uint32_t mdSize) {
+  closePoem(L);
+
+  PoemCacheHeader h;
+  bool ok = cache && cache.read((uint8_t*)&h, sizeof(h)) == sizeof(h)
+         && h.magic == POEM_CACHE_MAGIC && h.version == POEM_CACHE_VERSION
+         && h.mdSize == mdSize;
+  if (ok) {
+    // Same size; an edit that kept it still changes the hash
+    File md = LittleFS.open(mdPath, "r");
+    ok = md && sourceHash(md) == h.mdHash;
+    if (md) md.close();
+  }
+  if (!ok) {
+    if (cache) cache.close();
+    return false;
+  }
+
+  L.file = cache;
+  L.eof = false;
+  L.cursor = L.winPos = sizeof(h);
+  L.cached = true;
+  L.cacheLines = h.lines;
+  L.topPad = h.topPad;
+  L.totalHeight = h.totalHeight;
+  L.pastTitle = true;
+  strncpy(L.title, h.title, sizeof(L.title));
+  L.title[sizeof(L.title) - 1] = '\0';
+  return true;
+}
+
+static bool nextCachedLine(PoemLayout& L) {
+  PoemCacheLine rec;
+  int avail = fillWindow(L, POEM_CACHE_REC_MAX);
+  if ((uint32_t)L.count >= L.cacheLines || avail < (int)sizeof(rec)) {
+    L.eof = true;   // totalHeight came with the header
+    return false;
+  }
+  const char* p = cursorPtr(L);
+  memcpy(&rec, p, sizeof(rec));
+  int runBytes = sizeof(TextRun) * rec.runs;
+  if (rec.runs > MAX_LINE_RUNS || rec.len >= MAX_DLINE_LEN ||
+      avail < (int)sizeof(rec) + runBytes + rec.len) {
+    L.eof = true;   // truncated or corrupt: stop where the good records end
+    return false;
+  }
+  p += sizeof(rec);
+
+  PoemLine& ln = poemLine(L, L.count);
+  memcpy(ln.run, p, runBytes);
+  memcpy(ln.text, p + runBytes, rec.len);
+  ln.text[rec.len] = '\0';
+  ln.runs = rec.runs;
+  ln.pos = rec.pos;
+  ln.y = rec.y;
+  ln.width = rec.width;
+  ln.type = rec.type;
+  ln.quote = rec.quote;
+  L.cursor += sizeof(rec) + runBytes + rec.len;
+  L.nextY = rec.y + lineHeight(rec.type);
+  L.count++;
+  return true;
+}
+
+// Parabolic left indent, 6 + k*dy^2 with dy measured from the line's middle
+// to screen centre.  k=0.0065 matches the old circle for dy<100.  Sampled
+// per screen row at compile time for every top Y a visible body line can
+// have (-BODY_LINE_H..240).  dy changes sign exactly on a row boundary, so
+// within a row the curve is the chord between the two samples minus
+// k*t*(1-t), which is added back in integer math.
+#define INDENT_ROW_MIN (-BODY_LINE_H)
+#define INDENT_ROWS    (240 - INDENT_ROW_MIN + 2)
+#define INDENT_K_NUM   13      // k = 13/2000
+#define INDENT_K_DEN   2000
+
+struct IndentTable { int32_t q[INDENT_ROWS]; };
+
+static constexpr IndentTable makeIndentTable() {
+  IndentTable t{};
+  for (int r = 0; r < INDENT_ROWS; r++) {
+    int64_t dy = r + INDENT_ROW_MIN + BODY_LINE_H / 2 - 120;
+    t.q[r] = 6 * Q16_ONE + (int32_t)(dy * dy * INDENT_K_NUM * Q16_ONE / INDENT_K_DEN);
+  }
+  return t;
+}
+
+static constexpr IndentTable indentTable = makeIndentTable();
+
+int32_t leftEdgeQ16(int32_t screenYq) {
+  int r = q16Floor(screenYq) - INDENT_ROW_MIN;
+  if (r < 0) return indentTable.q[0];
+  if (r >= INDENT_ROWS - 1) return indentTable.q[INDENT_ROWS - 1];
+  int64_t t = screenYq & (Q16_ONE - 1);
+  int32_t a = indentTable.q[r], b = indentTable.q[r + 1];
+  int64_t bow = t * (Q16_ONE - t) * INDENT_K_NUM / ((int64_t)INDENT_K_DEN * Q16_ONE);
+  return a + (int32_t)(((b - a) * t) >> Q16_SHIFT) - (int32_t)bow;
+}
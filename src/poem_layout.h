@@ -0,0 +1,147 @@
+#pragma once
+
+#include <Arduino.h>
+#include <FS.h>
+
+// ============================================================
+// Poem text layout: title extraction, word wrap and line metrics.
+// The body is streamed: display lines are wrapped on demand from a
+// small sliding read window over the open file and kept in a ring
+// around the viewport, so RAM stays bounded for any file length.
+// Markdown is tokenized in place on the window while wrapping:
+// "#" headings, "> " blockquotes, *emphasis*, **bold** and blank-line
+// stanza breaks become line types and (offset, length, style) runs
+// over each line's source bytes.
+// A binary layout cache next to each poem holds its finished display
+// lines, so reopening it reads records instead of wrapping and measuring.
+// Kept free of sprite state so it can be benchmarked on the host
+// (see bench/).
+// ============================================================
+
+// Display line types
+enum LineType : uint8_t { LINE_TITLE, LINE_BODY, LINE_WRAP, LINE_HEADING, LINE_STANZA };
+
+// Inline run style bits
+#define RUN_EMPH 0x01
+#define RUN_BOLD 0x02
+
+struct TextRun {
+  uint8_t off;       // first byte within PoemLine::text
+  uint8_t len;
+  uint8_t style;     // RUN_* bits
+};
+
+#define MAX_TITLE_LEN 64
+#define MAX_DLINE_LEN 34    // source bytes per display line, markup included
+#define MAX_LINE_RUNS 6     // style runs per display line (the rest merge into the last)
+#define TITLE_WRAP    16
+#define BODY_WRAP     32
+#define QUOTE_WRAP    (BODY_WRAP - 2)
+#define MARK_SCAN     96    // how far ahead an opening '*' looks for its close
+
+#define POEM_WINDOW   256   // sliding read window over the file (bytes)
+#define POEM_RING     16    // display lines kept around the viewport
+
+// Q16.16 fixed point: scroll position, line Y and sub-pixel X all use it so
+// the hot path stays integer and host/ESP32 output is bit-identical.
+#define Q16_SHIFT 16
+#define Q16_ONE   (1 << Q16_SHIFT)
+static inline int32_t toQ16(int v) { return (int32_t)v * Q16_ONE; }
+static inline int q16Floor(int32_t v) { return v >> Q16_SHIFT; }
+
+// Layout
+static const int TITLE_LINE_H = 28;
+static const int BODY_LINE_H  = 20;
+static const int TITLE_BODY_GAP = 20;
+static const int QUOTE_INDENT = 10;
+
+static inline int lineHeight(LineType t) { return t == LINE_TITLE ? TITLE_LINE_H : BODY_LINE_H; }
+
+struct PoemLine {
+  char text[MAX_DLINE_LEN];      // source bytes (markers and all)
+  TextRun run[MAX_LINE_RUNS];    // visible text, in order
+  uint8_t runs;
+  bool quote;
+  LineType type;
+  int16_t width;                 // pixel width
+  uint32_t pos;                  // file offset of text[0] (0 for title lines)
+  int32_t y;                     // content Y of the line top
+};
+
+struct PoemLayout {
+  File file;
+  char window[POEM_WINDOW];     // file bytes [winPos, winPos + winLen)
+  uint32_t winPos;
+  int winLen;
+  uint32_t cursor;              // next unconsumed file offset
+  bool lineStart;               // cursor is at the start of a source line
+  bool pastTitle;
+  // Markdown state carried across the wrapped lines of one source line
+  LineType kind;                // LINE_BODY or LINE_HEADING
+  bool quote;
+  bool hardBreak;               // last line was cut mid-word
+  uint8_t style;                // open RUN_* bits
+  bool eof;                     // every display line has been produced
+
+  bool cached;                  // file is a layout cache, lines come from it
+  uint32_t cacheLines;          // display lines in the cache
+
+  char title[MAX_TITLE_LEN];
+  PoemLine line[POEM_RING];     // display line n lives in line[n % POEM_RING]
+  int first;                    // oldest display line still kept
+  int count;                    // display lines produced so far
+  int topPad;
+  int32_t nextY;                // content Y of the next display line
+  int totalHeight;              // content height, valid once eof
+};
+
+// Copy run r of a line out as a C string (out holds MAX_DLINE_LEN)
+static inline void poemRunText(const PoemLine& ln, int r, char* out) {
+  memcpy(out, ln.text + ln.run[r].off, ln.run[r].len);
+  out[ln.run[r].len] = '\0';
+}
+
+static inline bool poemRunBold(const PoemLine& ln, int r) {
+  return ln.type == LINE_HEADING || (ln.run[r].style & RUN_BOLD);
+}
+
+static inline PoemLine& poemLine(PoemLayout& L, int n) { return L.line[n % POEM_RING]; }
+static inline const PoemLine& poemLine(const PoemLayout& L, int n) { return L.line[n % POEM_RING]; }
+
+// Wrap an in-memory line at word boundaries into display lines.  pos is the
+// file offset of text[0], recorded in each line.
+void wordWrap(PoemLayout& L, const char* text, int maxChars, LineType firstType, LineType wrapType,
+              uint32_t pos = 0);
+
+// Start streaming f: reads the title from a leading "# " line, lays out the
+// title lines and positions the cursor at the body.  Takes ownership of f.
+void openPoem(PoemLayout& L, File f);
+
+// Wrap the next body display line into the ring.  Returns false at the end
+// of the file (eof and totalHeight are then set) or when the ring is full.
+bool nextPoemLine(PoemLayout& L);
+
+// Forget the oldest kept display line
+static inline void dropPoemLine(PoemLayout& L) { if (L.first < L.count) L.first++; }
+
+// Close the file and clear all lines
+void closePoem(PoemLayout& L);
+
+// --- Layout cache ---
+
+// Cache file for a poem: ".<name>.lay" in the same folder
+void poemCachePath(const char* mdPath, char* out, size_t outSize);
+
+// Lay out the whole poem at mdPath on LittleFS and write its cache.
+// Returns false (and leaves no cache behind) on any failure.
+bool buildPoemCache(const char* mdPath);
+
+// Like openPoem(), but display lines are read from cache.  Returns false,
+// leaving L closed, if the cache is from another format version or was not
+// built from the mdSize-byte .md at mdPath as it is now (its hash is
+// checked when the size matches).  Takes ownership of cache either way.
+bool openPoemCached(PoemLayout& L, File cache, const char* mdPath, uint32_t mdSize);
+
+// Parabolic left indent (Q16) for a body line whose top is at screen Y
+// (Q16).  Looked up in a per-screen-row table and interpolated linearly.
+int32_t leftEdgeQ16(int32_t screenYq);
@@ -0,0 +1,116 @@
+#include <Arduino.h>
+#include "poem_raster.h"
+#include "modes.h"
+#include "subpixel.h"
+#include "gamma_lut.h"
+#include "arena.h"
+
+const uint16_t stripPalette[4] = {COL_BG, COL_TITLE, COL_BODY, COL_WRAP};
+
+struct FramePalette { uint16_t c[16]; };
+
+static constexpr FramePalette makeFramePalette() {
+  FramePalette p{};
+  const uint16_t colors[4] = {COL_BG, COL_TITLE, COL_BODY, COL_WRAP};
+  for (int c = 1; c < 4; c++) {
+    for (int l = 1; l <= SUBPIXEL_LEVELS; l++) {
+      p.c[frameIndex(c, l)] = coverage565(colors[c], l, SUBPIXEL_LEVELS);
+    }
+  }
+  return p;
+}
+
+static constexpr FramePalette framePaletteTable = makeFramePalette();
+const uint16_t* const framePalette = framePaletteTable.c;
+
+static inline uint16_t bswap16(uint16_t v) { return (v >> 8) | (v << 8); }
+
+void drawPoemLineAt(TFT_eSPI& g, const PoemLine& ln, int x, int y) {
+  g.setTextDatum(TL_DATUM);
+
+  if (ln.type == LINE_TITLE) {
+    g.setTextColor(COL_TITLE);
+    g.setTextFont(4);
+    g.drawString(ln.text, x, y);
+    return;
+  }
+
+  if (ln.quote) {
+    g.fillRect(x, y, 2, BODY_LINE_H, COL_WRAP);
+    x += QUOTE_INDENT;
+  }
+  if (ln.type == LINE_WRAP) {
+    int ay = y + BODY_LINE_H / 2;
+    g.fillTriangle(x, ay - 3, x, ay + 3, x + 4, ay, COL_WRAP);
+    x += 12;
+  }
+
+  // Emphasis and headings in the accent color, bold double-struck
+  char buf[MAX_DLINE_LEN];
+  g.setTextFont(2);
+  for (int r = 0; r < ln.runs; r++) {
+    poemRunText(ln, r, buf);
+    bool bold = poemRunBold(ln, r);
+    bool accent = ln.type == LINE_HEADING || (ln.run[r].style & RUN_EMPH);
+    g.setTextColor(accent ? COL_TITLE : COL_BODY);
+    g.drawString(buf, x, y);
+    if (bold) g.drawString(buf, x + 1, y);
+    x += g.textWidth(buf, 2) + (bold ? 1 : 0);
+  }
+}
+
+int drawPoemLine(TFT_eSprite& lineSpr, const PoemLayout& L, int n) {
+  const PoemLine& ln = poemLine(L, n);
+  lineSpr.fillSprite(COL_BG);
+  drawPoemLineAt(lineSpr, ln, 0, 0);
+  return ln.width;
+}
+
+// Map a rendered pixel to its palette index (fonts are not anti-aliased,
+// so every lit pixel is exactly one of the palette colors).
+static inline uint32_t paletteIndex(uint16_t c) {
+  if (c == COL_BG) return 0;
+  if (c == COL_TITLE) return 1;
+  if (c == COL_WRAP) return 3;
+  return 2;
+}
+
+bool initPoemRaster(PoemRaster& R) {
+  if (R.words) return true;
+  R.words = arenaNew<uint32_t>((size_t)POEM_RING * STRIP_SLOT_WORDS);
+  return R.words != nullptr;
+}
+
+void rasterizePoemLine(PoemRaster& R, const PoemLayout& L, int n, TFT_eSprite& lineSpr) {
+  const uint16_t* src = (const uint16_t*)lineSpr.getPointer();
+  if (!src || !R.words) return;
+
+  drawPoemLine(lineSpr, L, n);
+  const PoemLine& ln = poemLine(L, n);
+  int slot = n % POEM_RING;
+  int w = ln.width;
+  if (w > 240) w = 240;
+  if (w < 0) w = 0;
+  R.width[slot] = w;
+  R.stride[slot] = (w + 15) / 16;
+
+  uint32_t* dst = R.words + slot * STRIP_SLOT_WORDS;
+  int h = lineHeight(ln.type);
+  for (int row = 0; row < h; row++) {
+    const uint16_t* sr = src + row * lineSpr.width();
+    for (int wd = 0; wd < R.stride[slot]; wd++) {
+      uint32_t packed = 0;
+      int x0 = wd * 16;
+      int k1 = w - x0;
+      if (k1 > 16) k1 = 16;
+      for (int k = 0; k < k1; k++) {
+        packed |= paletteIndex(bswap16(sr[x0 + k])) << (k * 2);
+      }
+      *dst++ = packed;
+    }
+  }
+}
+
+void freePoemRaster(PoemRaster& R) {
+  R.words = nullptr;   // the memory goes back with the arena
+}
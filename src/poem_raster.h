@@ -0,0 +1,57 @@
+#pragma once
+
+#include <TFT_eSPI.h>
+#include "poem_layout.h"
+
+// ============================================================
+// Pre-rasterized poem lines. Each display line is drawn once as it
+// enters the layout ring and packed into a 2-bit palette-indexed strip
+// (16 pixels per 32-bit word, index 0 = transparent) in the matching
+// ring slot, so scrolling only composites.
+// ============================================================
+
+// Color palette (RGB565).  The strips are drawn in these; the frame
+// palette blends each one over the background with coverage565().
+#define COL_BG     0x0000   // Black background
+#define COL_TITLE  0xE500   // Warm gold   (R=28,G=40,B=0)
+#define COL_BODY   0xFFFF   // Pure white  (R=31,G=63,B=31)
+#define COL_WRAP   0xA514   // Light gray  (R=20,G=40,B=20)
+
+// Strip palette, indexed by the 2-bit pixel value
+extern const uint16_t stripPalette[4];
+
+// 4-bit frame palette: background, then each strip color ramped over
+// SUBPIXEL_LEVELS gamma-correct coverage steps (see subpixel.h)
+extern const uint16_t* const framePalette;
+
+// Words per strip slot: the widest (240 px) and tallest (title) line
+#define STRIP_SLOT_WORDS ((240 / 16) * TITLE_LINE_H)
+
+struct PoemRaster {
+  uint32_t* words;                // POEM_RING slots of STRIP_SLOT_WORDS
+  uint16_t width[POEM_RING];      // pixels per row
+  uint8_t stride[POEM_RING];      // words per row
+};
+
+// Strip of display line n (which must still be kept in the layout ring)
+static inline const uint32_t* poemStrip(const PoemRaster& R, int n) {
+  return R.words + (n % POEM_RING) * STRIP_SLOT_WORDS;
+}
+
+// Draw a display line with its top-left at (x, y): runs in their styles,
+// plus the wrap arrow and quote bar where they apply.
+void drawPoemLineAt(TFT_eSPI& g, const PoemLine& ln, int x, int y);
+
+// Draw display line n at the top-left of a 16-bit line sprite (cleared to
+// COL_BG first).  Returns the pixel width to blit.
+int drawPoemLine(TFT_eSprite& lineSpr, const PoemLayout& L, int n);
+
+// Allocate the strip slots once, from the mode arena.  Returns false if
+// memory ran out.
+bool initPoemRaster(PoemRaster& R);
+
+// Rasterize display line n of L into its slot, using lineSpr as scratch
+void rasterizePoemLine(PoemRaster& R, const PoemLayout& L, int n, TFT_eSprite& lineSpr);
+
+// Drop the strips; their memory is reclaimed by the next arenaRelease()
+void freePoemRaster(PoemRaster& R);
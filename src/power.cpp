@@ -0,0 +1,142 @@
+#include <Arduino.h>
+#include <esp_adc_cal.h>
+#include <esp_sleep.h>
+#include <driver/ledc.h>
+#include "power.h"
+#include "pins.h"
+#include "frame_sched.h"
+
+#define BAT_PRESENT_MV  2500   // below this the divider reads no battery
+#define BAT_HYST_PCT    3      // extra charge needed to step back up a tier
+
+#define BL_CHANNEL LEDC_CHANNEL_0
+#define BL_TIMER   LEDC_TIMER_0
+#define BL_FREQ_HZ 5000
+
+// Open-circuit LiPo discharge curve (mV → %), linear between points
+struct CurvePoint { uint16_t mv; uint8_t pct; };
+static const CurvePoint curve[] = {
+  {3300, 0}, {3600, 5}, {3700, 15}, {3750, 25}, {3790, 40}, {3830, 50},
+  {3870, 60}, {3920, 70}, {3980, 80}, {4060, 90}, {4200, 100},
+};
+static const int CURVE_POINTS = sizeof(curve) / sizeof(curve[0]);
+
+// Governor tiers, best first: a tier applies from minPct upwards
+struct PowerTier {
+  uint8_t minPct;
+  uint16_t cpuMhz;    // 80 and up keeps APB (and so SPI) at 80 MHz
+  uint16_t fpsCap;    // 0 = modes run at their own rate
+  uint8_t backlight;
+};
+static const PowerTier tiers[] = {
+  {50, 240, 0, 255},
+  {25, 160, 30, 170},
+  {10, 80, 20, 96},
+  {0, 80, 10, 48},
+};
+static const int TIER_COUNT = sizeof(tiers) / sizeof(tiers[0]);
+
+static esp_adc_cal_characteristics_t adcChars;
+static uint32_t smoothMv = 0;
+static int percent = -1;
+static int tier = -1;
+static unsigned long lastSampleMs = 0;
+
+static uint32_t sampleMillivolts() {
+  uint32_t sum = 0;
+  for (int i = 0; i < BAT_OVERSAMPLE; i++) sum += analogRead(BAT_ADC_PIN);
+  uint32_t pinMv = esp_adc_cal_raw_to_voltage(sum / BAT_OVERSAMPLE, &adcChars);
+  return pinMv * 2;   // 100K/100K divider
+}
+
+static int curvePercent(uint32_t mv) {
+  if (mv <= curve[0].mv) return 0;
+  for (int i = 1; i < CURVE_POINTS; i++) {
+    if (mv < curve[i].mv) {
+      const CurvePoint& a = curve[i - 1];
+      const CurvePoint& b = curve[i];
+      return a.pct + (int)(mv - a.mv) * (b.pct - a.pct) / (b.mv - a.mv);
+    }
+  }
+  return 100;
+}
+
+// Lowest tier whose threshold the charge meets; stepping back up to a
+// better tier needs BAT_HYST_PCT more, so a reading hovering on a boundary
+// does not flap the clock and backlight
+static int pickTier(int pct) {
+  if (pct < 0) return 0;   // no battery: on external power
+  int t = 0;
+  while (t < TIER_COUNT - 1 && pct < tiers[t].minPct) t++;
+  if (tier >= 0 && t < tier && pct < tiers[t].minPct + BAT_HYST_PCT) t = tier;
+  return t;
+}
+
+static void applyTier(int t) {
+  if (t == tier) return;
+  tier = t;
+  const PowerTier& p = tiers[t];
+  setCpuFrequencyMhz(p.cpuMhz);
+  schedSetCap(p.fpsCap);
+  backlightSet(p.backlight);
+  char cap[12] = "none";
+  if (p.fpsCap) snprintf(cap, sizeof(cap), "%u fps", p.fpsCap);
+  if (percent < 0) Serial.print("Power: no battery");
+  else Serial.printf("Power: battery %lu mV (%d%%)", (unsigned long)smoothMv, percent);
+  Serial.printf(" -> %u MHz, frame cap %s, backlight %u\n", p.cpuMhz, cap, p.backlight);
+  if (t == TIER_COUNT - 1) Serial.println("Power: battery low, charge soon");
+}
+
+static void sample() {
+  uint32_t mv = sampleMillivolts();
+  lastSampleMs = millis();
+  if (mv < BAT_PRESENT_MV) {
+    smoothMv = 0;
+    percent = -1;
+  } else {
+    // Exponential smoothing (1/4 weight) over backlight and SPI load steps
+    smoothMv = smoothMv ? (smoothMv * 3 + mv) / 4 : mv;
+    percent = curvePercent(smoothMv);
+  }
+  applyTier(pickTier(percent));
+}
+
+void backlightSet(uint8_t duty) {
+  // 8-bit duty 255 still drops one count in 256; full scale is 256
+  ledc_set_duty(LEDC_LOW_SPEED_MODE, BL_CHANNEL, duty == 255 ? 256 : duty);
+  ledc_update_duty(LEDC_LOW_SPEED_MODE, BL_CHANNEL);
+}
+
+void powerInit() {
+  analogReadResolution(12);
+  analogSetPinAttenuation(BAT_ADC_PIN, ADC_11db);
+  esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN_DB_11, ADC_WIDTH_BIT_12, 1100, &adcChars);
+
+  // The RC fast clock keeps running in light sleep (kept powered here), so
+  // a dimmed backlight holds its level while the loop sleeps
+  ledc_timer_config_t timer = {};
+  timer.speed_mode = LEDC_LOW_SPEED_MODE;
+  timer.duty_resolution = LEDC_TIMER_8_BIT;
+  timer.timer_num = BL_TIMER;
+  timer.freq_hz = BL_FREQ_HZ;
+  timer.clk_cfg = LEDC_USE_RTC8M_CLK;
+  ledc_timer_config(&timer);
+  esp_sleep_pd_config(ESP_PD_DOMAIN_RTC8M, ESP_PD_OPTION_ON);
+
+  ledc_channel_config_t ch = {};
+  ch.gpio_num = TFT_BL;
+  ch.speed_mode = LEDC_LOW_SPEED_MODE;
+  ch.channel = BL_CHANNEL;
+  ch.timer_sel = BL_TIMER;
+  ch.duty = 256;
+  ledc_channel_config(&ch);
+
+  sample();
+}
+
+void powerPoll() {
+  if (millis() - lastSampleMs >= BAT_SAMPLE_MS) sample();
+}
+
+uint32_t batteryMillivolts() { return smoothMv; }
+int batteryPercent() { return percent; }
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stdint.h>
+
+// ============================================================
+// Battery telemetry and the performance governor.  The battery is read
+// on BAT_ADC_PIN through the board's 100K/100K divider: a burst of
+// oversampled, eFuse-calibrated readings every few seconds, smoothed,
+// then mapped onto a LiPo discharge curve.  As charge falls the governor
+// steps down through power tiers — CPU clock, a frame-rate cap and
+// backlight brightness (PWM on TFT_BL) — with hysteresis between them.
+// ============================================================
+
+#define BAT_SAMPLE_MS   5000   // between sample bursts
+#define BAT_OVERSAMPLE  16     // ADC reads averaged per burst
+
+// Set up the ADC calibration and the backlight PWM (at full brightness),
+// and take the first sample.  Call early in setup(), instead of driving
+// TFT_BL as a plain GPIO.
+void powerInit();
+
+// Take a sample burst if one is due and retune the governor.  Cheap when
+// none is due; call once per loop().
+void powerPoll();
+
+// Smoothed battery voltage in mV (0 when no battery is connected: the ADC
+// jumper pad is open, or the board runs from USB)
+uint32_t batteryMillivolts();
+
+// State of charge 0..100, or -1 when no battery is connected
+int batteryPercent();
+
+// Backlight duty, 0 (off) .. 255 (full)
+void backlightSet(uint8_t duty);
@@ -0,0 +1,224 @@
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include "prefetch.h"
+#include "modes.h"
+#include "arena.h"
+
+enum SlotState : uint8_t {
+  SLOT_EMPTY,
+  SLOT_DECODING,
+  SLOT_READY,
+  SLOT_FAILED     // decode failed; kept so the image is not retried
+};
+
+struct Slot {
+  uint16_t* frame;
+  int idx;          // image held (or being decoded), -1 for none
+  SlotState state;
+  uint32_t lastUse;
+};
+
+static Slot slots[PREFETCH_FRAMES];
+static bool active = false;
+static int imageCount = 0;
+static PrefetchDecode decodeFn = nullptr;
+
+// Images wanted, in decode order: current, ahead, behind (-1 = unused)
+static int wanted[3] = {-1, -1, -1};
+static uint32_t useTick = 0;
+static uint32_t hits = 0, misses = 0;
+
+// Guards everything above, shared with the task
+static SemaphoreHandle_t lock = nullptr;
+static SemaphoreHandle_t kickSem = nullptr;   // new targets for the task
+static SemaphoreHandle_t doneSem = nullptr;   // a decode finished
+static volatile bool taskRunning = false;
+static volatile bool quit = false;
+
+// Aborts the decode in progress from inside tft_output (see main.cpp)
+volatile bool jpgCancel = false;
+
+static void take() { xSemaphoreTake(lock, portMAX_DELAY); }
+static void give() { xSemaphoreGive(lock); }
+
+static bool isWanted(int idx) {
+  return idx >= 0 && (idx == wanted[0] || idx == wanted[1] || idx == wanted[2]);
+}
+
+static Slot* findSlot(int idx) {
+  for (Slot& s : slots) {
+    if (s.idx == idx && s.state != SLOT_EMPTY) return &s;
+  }
+  return nullptr;
+}
+
+// Least recently used slot not holding a wanted image.  With three wanted
+// images and PREFETCH_FRAMES >= 4 there is always one.
+static Slot* victimSlot() {
+  Slot* victim = nullptr;
+  for (Slot& s : slots) {
+    if (s.state == SLOT_EMPTY) return &s;
+    if (isWanted(s.idx) || s.state == SLOT_DECODING) continue;
+    if (!victim || s.lastUse < victim->lastUse) victim = &s;
+  }
+  return victim;
+}
+
+// Decode wanted images until all are in the cache (or failed).  Runs on
+// the prefetch task.
+static void runPrefetch() {
+  while (!quit) {
+    take();
+    Slot* slot = nullptr;
+    int idx = -1;
+    for (int w : wanted) {
+      if (w >= 0 && !findSlot(w)) { idx = w; break; }
+    }
+    if (idx >= 0 && !quit) slot = victimSlot();
+    if (!slot) {
+      give();
+      return;
+    }
+    slot->idx = idx;
+    slot->state = SLOT_DECODING;
+    jpgCancel = false;
+    give();
+
+    bool ok = decodeFn(idx, slot->frame);
+
+    take();
+    if (jpgCancel) {
+      slot->idx = -1;
+      slot->state = SLOT_EMPTY;
+    } else {
+      slot->state = ok ? SLOT_READY : SLOT_FAILED;
+      slot->lastUse = ++useTick;
+    }
+    jpgCancel = false;
+    give();
+    xSemaphoreGive(doneSem);
+  }
+}
+
+// Sleeps between batches of work for the whole visit; prefetchEnd() ends it
+static void prefetchTask(void*) {
+  for (;;) {
+    runPrefetch();
+    if (quit || xSemaphoreTake(kickSem, portMAX_DELAY) != pdTRUE || quit) break;
+  }
+  taskRunning = false;
+  xSemaphoreGive(doneSem);
+  vTaskDelete(nullptr);
+}
+
+static void kick() {
+  if (taskRunning) {
+    xSemaphoreGive(kickSem);
+    return;
+  }
+  taskRunning = true;
+  // Core 0, away from loop() and the SPI pushes on core 1
+  if (xTaskCreatePinnedToCore(prefetchTask, "prefetch", 4096, nullptr, 1, nullptr, 0) != pdPASS) {
+    taskRunning = false;
+    Serial.println("Prefetch: task failed to start");
+  }
+}
+
+bool prefetchBegin(int count, PrefetchDecode decode) {
+  uint16_t* frames[PREFETCH_FRAMES];
+  for (int i = 0; i < PREFETCH_FRAMES; i++) {
+    frames[i] = arenaNew<uint16_t>(240 * 240);
+    if (!frames[i]) return false;   // what was taken goes with the arena
+  }
+  if (!lock) {
+    lock = xSemaphoreCreateMutex();
+    kickSem = xSemaphoreCreateBinary();
+    doneSem = xSemaphoreCreateBinary();
+  }
+  for (int i = 0; i < PREFETCH_FRAMES; i++) {
+    slots[i] = {frames[i], -1, SLOT_EMPTY, 0};
+  }
+  wanted[0] = wanted[1] = wanted[2] = -1;
+  imageCount = count;
+  decodeFn = decode;
+  useTick = 0;
+  hits = misses = 0;
+  quit = false;
+  active = true;
+  return true;
+}
+
+void prefetchEnd() {
+  if (!active) return;
+  active = false;
+  take();
+  quit = true;
+  jpgCancel = true;
+  give();
+  while (taskRunning) {
+    xSemaphoreGive(kickSem);
+    xSemaphoreTake(doneSem, pdMS_TO_TICKS(50));
+  }
+  jpgCancel = false;
+}
+
+void prefetchAround(int idx, int dir) {
+  if (!active) return;
+  take();
+  wanted[0] = idx;
+  wanted[1] = imageCount > 1 ? (idx + dir + imageCount) % imageCount : -1;
+  wanted[2] = imageCount > 2 ? (idx - dir + imageCount) % imageCount : -1;
+  // Turned around: drop the decode that is now behind us
+  for (Slot& s : slots) {
+    if (s.state == SLOT_DECODING && !isWanted(s.idx)) jpgCancel = true;
+  }
+  Slot* s = findSlot(idx);
+  if (s) s->lastUse = ++useTick;
+  give();
+  kick();
+}
+
+uint16_t* prefetchWait(int idx) {
+  if (!active) return nullptr;
+  for (;;) {
+    take();
+    Slot* s = findSlot(idx);
+    SlotState state = s ? s->state : SLOT_EMPTY;
+    uint16_t* frame = s ? s->frame : nullptr;
+    give();
+    if (state == SLOT_READY) return frame;
+    if (state == SLOT_FAILED) return nullptr;
+    // Still queued or decoding; with no task it never will be
+    if (!taskRunning) return nullptr;
+    xSemaphoreTake(doneSem, portMAX_DELAY);
+  }
+}
+
+uint16_t* prefetchGet(int idx, int dir) {
+  if (!active) return nullptr;
+  take();
+  Slot* s = findSlot(idx);
+  bool hit = s && s->state == SLOT_READY;
+  give();
+  if (hit) hits++;
+  else misses++;
+  prefetchAround(idx, dir);
+  return prefetchWait(idx);
+}
+
+bool prefetchBusy() {
+  if (!active || !taskRunning) return false;
+  take();
+  bool busy = false;
+  for (int w : wanted) {
+    Slot* s = w >= 0 ? findSlot(w) : nullptr;
+    if (w >= 0 && (!s || s->state == SLOT_DECODING)) busy = true;
+  }
+  give();
+  return busy;
+}
+
+uint32_t prefetchHits() { return hits; }
+uint32_t prefetchMisses() { return misses; }
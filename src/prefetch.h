@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stdint.h>
+
+// ============================================================
+// Decoded-image cache with background prefetch, for the Us mode.  A few
+// 240x240 RGB565 frames (SPI byte order, in the mode arena, so PSRAM)
+// hold recently shown and upcoming images.  A task on core 0 decodes the
+// images around the current one, the next one in the direction of travel
+// first, so a press is usually one full-screen push.  Frames are reused
+// least recently used first; a decode whose image is no longer wanted
+// (the user turned around) is abandoned mid-image.
+// ============================================================
+
+#define PREFETCH_FRAMES 4   // current, ahead, behind, and one spare
+
+// Decodes image idx into frame (240x240, cleared first by the callee).
+// Runs on the prefetch task; the task owns TJpgDec while it is running.
+typedef bool (*PrefetchDecode)(int idx, uint16_t* frame);
+
+// Allocate the frames from the mode arena and get ready to decode images
+// 0..count-1.  Returns false (and changes nothing) if they do not fit.
+bool prefetchBegin(int count, PrefetchDecode decode);
+
+// Stop the task and forget the frames.  Call from the mode's exit hook,
+// before the arena is released.
+void prefetchEnd();
+
+// Make idx the current image and queue it and its neighbours, idx + dir
+// first (dir = +1 or -1).  Returns at once.
+void prefetchAround(int idx, int dir);
+
+// Wait for image idx (queued by prefetchAround) to be decoded.  Returns
+// its frame, or nullptr if it could not be decoded.  The frame stays
+// valid until the next prefetchAround() call.
+uint16_t* prefetchWait(int idx);
+
+// A press: prefetchAround() then prefetchWait(), counted as a hit when
+// the image was already decoded
+uint16_t* prefetchGet(int idx, int dir);
+
+// True while a wanted image is still waiting to be decoded
+bool prefetchBusy();
+
+// Presses served from the cache / that had to wait for a decode
+uint32_t prefetchHits();
+uint32_t prefetchMisses();
@@ -0,0 +1,228 @@
+#include <Arduino.h>
+#include "q565.h"
+#include "band_push.h"
+#include "modes.h"
+
+#define Q565_READ_BYTES 1024
+#define Q565_HEADER     8
+
+#define OP_INDEX 0x00
+#define OP_DIFF  0x40
+#define OP_LUMA  0x80
+#define OP_RUN   0xC0
+#define OP_RGB   0xFE
+#define RUN_MAX  62
+
+static constexpr uint16_t bswap16(uint16_t v) { return (uint16_t)((v >> 8) | (v << 8)); }
+
+static inline uint8_t hashPx(uint16_t px) {
+  return ((px >> 11) * 3 + ((px >> 5) & 63) * 5 + (px & 31) * 7) & 63;
+}
+
+// Decoder state between calls, so a frame can be drawn a band at a time
+static struct {
+  File file;
+  uint32_t left;      // pixels still to decode
+  uint16_t px;        // previous pixel (native order)
+  uint8_t run;        // repeats of px still owed
+  bool bad;           // stream ended early or held a bad op
+  uint16_t pos, len;  // unread bytes are buf[pos, len)
+  uint16_t index[64];
+  uint8_t buf[Q565_READ_BYTES];
+} rd;
+
+static bool openReader(const char* path, fs::FS& fs) {
+  rd.file = fs.open(path, FILE_READ);
+  if (!rd.file) return false;
+  uint8_t h[Q565_HEADER];
+  if (rd.file.read(h, sizeof(h)) != sizeof(h) || memcmp(h, "Q565", 4) != 0 ||
+      (h[4] | h[5] << 8) != Q565_SIZE || (h[6] | h[7] << 8) != Q565_SIZE) {
+    Serial.printf("q565: %s is not a %dx%d Q565 image\n", path, Q565_SIZE, Q565_SIZE);
+    rd.file.close();
+    return false;
+  }
+  rd.left = Q565_PIXELS;
+  rd.px = 0;
+  rd.run = 0;
+  rd.bad = false;
+  rd.pos = rd.len = 0;
+  memset(rd.index, 0, sizeof(rd.index));
+  return true;
+}
+
+// Keep what is left of buf and read more after it
+static void refill() {
+  uint16_t keep = rd.len - rd.pos;
+  memmove(rd.buf, rd.buf + rd.pos, keep);
+  rd.pos = 0;
+  rd.len = keep + rd.file.read(rd.buf + keep, Q565_READ_BYTES - keep);
+}
+
+// Decode the next count pixels into out (SPI byte order); after an error
+// the rest are black
+static void readPixels(uint16_t* out, uint32_t count) {
+  uint16_t px = rd.px;
+  while (count) {
+    if (rd.run) {
+      uint32_t n = rd.run < count ? rd.run : count;
+      uint16_t wire = bswap16(px);
+      for (uint32_t i = 0; i < n; i++) out[i] = wire;
+      out += n;
+      count -= n;
+      rd.run -= n;
+      continue;
+    }
+    if (rd.bad) {
+      memset(out, 0, count * sizeof(uint16_t));
+      break;
+    }
+    // The longest op is 3 bytes
+    if (rd.len - rd.pos < 3) refill();
+    uint16_t avail = rd.len - rd.pos;
+    if (avail == 0) { rd.bad = true; continue; }
+    const uint8_t* p = rd.buf + rd.pos;
+    uint8_t op = p[0];
+    if (op < OP_DIFF) {
+      px = rd.index[op];
+      rd.pos += 1;
+    } else if (op < OP_LUMA) {
+      uint16_t r = ((px >> 11) + ((op >> 4) & 3) - 2) & 31;
+      uint16_t g = (((px >> 5) & 63) + ((op >> 2) & 3) - 2) & 63;
+      uint16_t b = ((px & 31) + (op & 3) - 2) & 31;
+      px = r << 11 | g << 5 | b;
+      rd.pos += 1;
+    } else if (op < OP_RUN) {
+      if (avail < 2) { rd.bad = true; continue; }
+      int dg = (op & 63) - 32;
+      int half = dg >> 1;
+      uint16_t r = ((px >> 11) + half + (p[1] >> 4) - 8) & 31;
+      uint16_t g = (((px >> 5) & 63) + dg) & 63;
+      uint16_t b = ((px & 31) + half + (p[1] & 15) - 8) & 31;
+      px = r << 11 | g << 5 | b;
+      rd.pos += 2;
+    } else if (op < OP_RGB) {
+      rd.run = op - OP_RUN + 1;
+      rd.pos += 1;
+      if (rd.run > rd.left) {
+        rd.run = 0;
+        rd.bad = true;
+      } else {
+        rd.left -= rd.run;
+      }
+      continue;
+    } else {
+      if (op != OP_RGB || avail < 3) { rd.bad = true; continue; }
+      px = p[1] << 8 | p[2];
+      rd.pos += 3;
+    }
+    rd.index[hashPx(px)] = px;
+    *out++ = bswap16(px);
+    count--;
+    rd.left--;
+  }
+  rd.px = px;
+}
+
+static bool closeReader() {
+  rd.file.close();
+  return !rd.bad;
+}
+
+bool q565DecodeFile(const char* path, fs::FS& fs, uint16_t* frame) {
+  if (!openReader(path, fs)) return false;
+  readPixels(frame, Q565_PIXELS);
+  return closeReader();
+}
+
+static void renderRows(uint16_t* band, int /*y0*/, int rows, void*) {
+  readPixels(band, rows * Q565_SIZE);
+}
+
+bool q565Draw(const char* path, fs::FS& fs) {
+  if (!openReader(path, fs)) return false;
+  if (bandPushInit()) {
+    // Each band is decoded while the one before it goes out by DMA
+    bandPushFrame(renderRows, nullptr);
+  } else {
+    static uint16_t row[Q565_SIZE];
+    bool swap = tft.getSwapBytes();
+    tft.setSwapBytes(false);
+    tft.startWrite();
+    for (int y = 0; y < Q565_SIZE; y++) {
+      readPixels(row, Q565_SIZE);
+      tft.pushImage(0, y, Q565_SIZE, 1, row);
+    }
+    tft.endWrite();
+    tft.setSwapBytes(swap);
+  }
+  return closeReader();
+}
+
+// --- Encoder ---
+
+struct Writer {
+  File& f;
+  uint8_t buf[256];
+  size_t n;
+  bool ok;
+
+  void put(uint8_t b) {
+    buf[n++] = b;
+    if (n == sizeof(buf)) flush();
+  }
+  void flush() {
+    if (n && f.write(buf, n) != n) ok = false;
+    n = 0;
+  }
+};
+
+bool q565Write(fs::File& f, const uint16_t* frame) {
+  Writer w = {f, {}, 0, true};
+  const uint8_t header[Q565_HEADER] = {'Q', '5', '6', '5', Q565_SIZE & 0xFF, Q565_SIZE >> 8,
+                                       Q565_SIZE & 0xFF, Q565_SIZE >> 8};
+  for (uint8_t b : header) w.put(b);
+
+  uint16_t index[64] = {0};
+  uint16_t prev = 0;
+  int run = 0;
+  for (int i = 0; i < Q565_PIXELS; i++) {
+    uint16_t px = bswap16(frame[i]);
+    if (px == prev) {
+      if (++run == RUN_MAX) {
+        w.put(OP_RUN + run - 1);
+        run = 0;
+      }
+      continue;
+    }
+    if (run) {
+      w.put(OP_RUN + run - 1);
+      run = 0;
+    }
+
+    uint8_t h = hashPx(px);
+    if (index[h] == px) {
+      w.put(OP_INDEX | h);
+    } else {
+      index[h] = px;
+      // Channel differences, wrapped to the channel width
+      int dr = (((px >> 11) - (prev >> 11) + 16) & 31) - 16;
+      int dg = ((((px >> 5) & 63) - ((prev >> 5) & 63) + 32) & 63) - 32;
+      int db = (((px & 31) - (prev & 31) + 16) & 31) - 16;
+      int rg = dr - (dg >> 1), bg = db - (dg >> 1);
+      if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+        w.put(OP_DIFF | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2));
+      } else if (rg >= -8 && rg <= 7 && bg >= -8 && bg <= 7) {
+        w.put(OP_LUMA | (dg + 32));
+        w.put((rg + 8) << 4 | (bg + 8));
+      } else {
+        w.put(OP_RGB);
+        w.put(px >> 8);
+        w.put(px & 0xFF);
+      }
+    }
+    prev = px;
+  }
+  if (run) w.put(OP_RUN + run - 1);
+  w.flush();
+  return w.ok;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <FS.h>
+
+// ============================================================
+// Q565: a display-native image format for the Us mode.  A 240x240
+// RGB565 frame compressed QOI-style, so decoding is a byte switch per
+// pixel with no transforms or colour conversion, and drawing one is
+// bound by the SPI bus rather than the CPU.
+//
+// File: "Q565", width and height (uint16 little-endian, both 240), then
+// ops for 57600 pixels, rows top to bottom.  Each pixel is coded against
+// the previous one (black before the first) and a 64-entry table of
+// recent pixels, indexed by (r * 3 + g * 5 + b * 7) & 63 on the 5/6/5
+// bit channels:
+//   00iiiiii               INDEX  table[i]
+//   01rrggbb               DIFF   r, g, b each -2..1 (+2 biased)
+//   10gggggg rrrrbbbb      LUMA   g -32..31 (+32); r and b as
+//                                 -8..7 (+8) from g / 2 (rounded down)
+//   11nnnnnn               RUN    previous pixel 1..62 more times
+//                                 (0xC0..0xFD)
+//   11111110 hhhhhhhh llll RGB    pixel, big-endian (SPI byte order)
+// Channel differences wrap around.  Every pixel but a RUN's goes into the
+// table.
+// ============================================================
+
+#define Q565_SIZE   240
+#define Q565_PIXELS (Q565_SIZE * Q565_SIZE)
+
+// Decode path into frame (240x240 RGB565 in SPI byte order, as jpgFrame
+// holds).  Returns false if the file is missing, not Q565, or cut short
+// (the rest of the frame is then black).  One decode at a time, as with
+// TJpgDec.
+bool q565DecodeFile(const char* path, fs::FS& fs, uint16_t* frame);
+
+// Decode path straight to the panel, a band at a time into the band
+// push buffers (row by row without them).  Returns false, before drawing
+// anything, if the file is missing or not Q565; a file cut short draws
+// black for the rest and also returns false.
+bool q565Draw(const char* path, fs::FS& fs);
+
+// Encode frame (240x240, SPI byte order) to f.  Returns false if a write
+// fell short.
+bool q565Write(fs::File& f, const uint16_t* frame);
@@ -0,0 +1,135 @@
+#include <Arduino.h>
+#include "resample.h"
+
+static constexpr uint16_t bswap16(uint16_t v) { return (uint16_t)((v >> 8) | (v << 8)); }
+
+// a + (b - a) * w / 32 on all three channels at once: green moves to the
+// top half so each channel has room for the product
+static inline uint16_t lerp565(uint16_t a, uint16_t b, uint32_t w) {
+  uint32_t A = (a | (uint32_t)a << 16) & 0x07E0F81F;
+  uint32_t B = (b | (uint32_t)b << 16) & 0x07E0F81F;
+  uint32_t C = (A + (((B - A) * w) >> 5)) & 0x07E0F81F;
+  return (uint16_t)(C | C >> 16);
+}
+
+static volatile bool active = false;
+static uint16_t srcW, srcH;
+static int32_t stepQ16;    // source pixels per panel pixel
+static int32_t cropYQ16;   // source y of the panel's top edge
+
+// Per panel column: left source column and weight of the one after it
+static uint16_t colX0[RESAMPLE_SIZE];
+static uint8_t colW[RESAMPLE_SIZE];
+
+// The MCU row being received, resampled across (native RGB565), and the
+// last row of the one before it
+static uint16_t rows[RESAMPLE_ROWS][RESAMPLE_SIZE];
+static uint16_t above[RESAMPLE_SIZE];
+// Rightmost column of the previous block, per row
+static uint16_t carry[RESAMPLE_ROWS];
+// Output rows not yet sent, SPI byte order
+static uint16_t outRows[RESAMPLE_OUT_ROWS][RESAMPLE_SIZE];
+
+static int bandY;     // source y of the MCU row being received
+static int nextCol;   // first panel column of it not yet resampled
+static int nextRow;   // next panel row to send
+
+uint8_t resampleScale(uint16_t w, uint16_t h, uint16_t& sw, uint16_t& sh) {
+  uint8_t scale = 1;
+  while (scale < 8 && w / (scale * 2) >= RESAMPLE_SIZE && h / (scale * 2) >= RESAMPLE_SIZE) {
+    scale *= 2;
+  }
+  // The decoder drops the partial pixel at the right and bottom edges
+  sw = w / scale;
+  sh = h / scale;
+  return scale;
+}
+
+// Source position of panel pixel i along an axis: left/top sample, its
+// neighbour (clamped to the edge) and the neighbour's weight (0..31)
+static inline void sourcePos(int i, int32_t cropQ16, uint16_t size, int& p0, int& p1, uint8_t& w) {
+  int32_t f = cropQ16 + i * stepQ16 + stepQ16 / 2 - 0x8000;
+  int32_t maxQ16 = (int32_t)(size - 1) << 16;
+  if (f < 0) f = 0;
+  if (f > maxQ16) f = maxQ16;
+  p0 = f >> 16;
+  p1 = p0 + 1 < size ? p0 + 1 : p0;
+  w = (f >> 11) & 31;
+}
+
+void resampleBegin(uint16_t sw, uint16_t sh) {
+  active = sw && sh && !(sw == RESAMPLE_SIZE && sh == RESAMPLE_SIZE);
+  if (!active) return;
+  srcW = sw;
+  srcH = sh;
+  // Cover: the shorter side spans the panel, the longer is cropped evenly
+  stepQ16 = ((int32_t)(sw < sh ? sw : sh) << 16) / RESAMPLE_SIZE;
+  int32_t cropXQ16 = (((int32_t)sw << 16) - RESAMPLE_SIZE * stepQ16) / 2;
+  cropYQ16 = (((int32_t)sh << 16) - RESAMPLE_SIZE * stepQ16) / 2;
+  for (int c = 0; c < RESAMPLE_SIZE; c++) {
+    int x0, x1;
+    sourcePos(c, cropXQ16, sw, x0, x1, colW[c]);
+    colX0[c] = x0;
+  }
+  bandY = -1;
+  nextCol = 0;
+  nextRow = 0;
+}
+
+void resampleEnd() { active = false; }
+
+bool resampleActive() { return active; }
+
+bool resampleBlock(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint16_t* bitmap,
+                   ResampleSink out) {
+  if (y != bandY) {
+    bandY = y;
+    nextCol = 0;
+  }
+  if (nextRow >= RESAMPLE_SIZE) return 0;
+  // Past the edge pixel the decoder's scaling drops
+  if (x >= srcW || y >= srcH) return 1;
+  int rowsIn = min(min((int)h, srcH - y), RESAMPLE_ROWS);
+  int y0, y1;
+  uint8_t wy;
+  sourcePos(nextRow, cropYQ16, srcH, y0, y1, wy);
+  // Cropped off the top, and not the row above the next one needed
+  if (y + rowsIn - 1 < y0) return 1;
+
+  // Across: every panel column whose right sample is in this block (its
+  // left one is here or the previous block's last column)
+  int xEnd = min(x + w, (int)srcW);
+  for (; nextCol < RESAMPLE_SIZE; nextCol++) {
+    int c = nextCol, x0 = colX0[c];
+    int x1 = x0 + 1 < srcW ? x0 + 1 : x0;
+    if (x1 >= xEnd) break;
+    for (int r = 0; r < rowsIn; r++) {
+      const uint16_t* src = bitmap + r * w;
+      uint16_t a = x0 >= x ? bswap16(src[x0 - x]) : carry[r];
+      rows[r][c] = lerp565(a, bswap16(src[x1 - x]), colW[c]);
+    }
+  }
+  for (int r = 0; r < rowsIn; r++) carry[r] = bswap16(bitmap[r * w + xEnd - 1 - x]);
+  if (xEnd < srcW) return 1;
+
+  // MCU row complete: down, for every panel row whose samples are in it
+  // (or the row above it)
+  int last = y + rowsIn - 1;
+  while (nextRow < RESAMPLE_SIZE) {
+    sourcePos(nextRow, cropYQ16, srcH, y0, y1, wy);
+    if (y1 > last) break;
+    const uint16_t* a = y0 < y ? above : rows[y0 - y];
+    const uint16_t* b = y1 < y ? above : rows[y1 - y];
+    uint16_t* o = outRows[nextRow % RESAMPLE_OUT_ROWS];
+    for (int c = 0; c < RESAMPLE_SIZE; c++) o[c] = bswap16(lerp565(a[c], b[c], wy));
+    nextRow++;
+    // Out a band at a time: one block, one DMA transfer, per band
+    if (nextRow % RESAMPLE_OUT_ROWS == 0 &&
+        !out(0, nextRow - RESAMPLE_OUT_ROWS, RESAMPLE_SIZE, RESAMPLE_OUT_ROWS, outRows[0])) {
+      return 0;
+    }
+  }
+  memcpy(above, rows[rowsIn - 1], sizeof(above));
+  // Stop the decoder once the panel is full (the rest is cropped)
+  return nextRow < RESAMPLE_SIZE;
+}
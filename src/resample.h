@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stdint.h>
+
+// ============================================================
+// Streaming resampler between TJpgDec and the panel.  The decoder only
+// scales by 1/2/4/8, so a photo drawn that way is letterboxed or
+// cropped.  Instead it is decoded at the largest of those scales that
+// still covers the panel, and the resampler scales the decoded blocks
+// (bilinear, 16.16 fixed-point positions, 1/32 weights) to exactly fill
+// 240x240, cropping the longer side evenly.  Blocks are resampled across
+// as they arrive and down once their MCU row is complete, so it holds one
+// MCU row at panel width and the row above it; output leaves
+// RESAMPLE_OUT_ROWS rows at a time through the same sink the blocks would
+// have gone to.
+// ============================================================
+
+#define RESAMPLE_SIZE 240
+#define RESAMPLE_ROWS     16   // tallest MCU the decoder emits
+#define RESAMPLE_OUT_ROWS 4    // rows per output block (divides RESAMPLE_SIZE)
+
+static_assert(RESAMPLE_SIZE % RESAMPLE_OUT_ROWS == 0, "output bands must tile the panel");
+
+// Where resampled rows go (tft_output's panel / frame / pipeline sink)
+typedef bool (*ResampleSink)(int16_t x, int16_t y, uint16_t w, uint16_t h, uint16_t* bitmap);
+
+// Pick the decoder scale for a w x h JPEG: the largest of 1/2/4/8 that
+// leaves both sides at least 240 (1 if the image is smaller).  Sets sw x
+// sh to the decoded size.
+uint8_t resampleScale(uint16_t w, uint16_t h, uint16_t& sw, uint16_t& sh);
+
+// Resample the next decode, sw x sh pixels drawn at (0, 0), to fill the
+// panel.  A decode that is exactly 240x240 passes straight through.
+void resampleBegin(uint16_t sw, uint16_t sh);
+
+// Stop resampling (after the decode returns)
+void resampleEnd();
+
+// For tft_output: true while a decode is being resampled, and the sink
+// that takes a decoded block.  Returns false (stopping the decoder) once
+// the last panel row is out, or if out refused a row.
+bool resampleActive();
+bool resampleBlock(int16_t x, int16_t y, uint16_t w, uint16_t h, const uint16_t* bitmap,
+                   ResampleSink out);
@@ -1,12 +1,25 @@
 #include <Arduino.h>
 #include <SPI.h>
 #include <TFT_eSPI.h>
+#include <Preferences.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
 #include "sdcard.h"
 #include "pins.h"
 
 extern TFT_eSPI tft;
 
-static bool ready = false;
+static volatile bool ready = false;
+static volatile bool mountDone = false;
+static SemaphoreHandle_t mountSem = nullptr;   // given when the mount ends
+static uint32_t clockHz = 0;                   // SPI clock of the mount
+static uint32_t cardId = 0;                    // readProbe() at the safe clock
+static bool stepPending = false;               // at a safe clock, not stepped up
+
+// Clock step-up: each rate must read the probe sectors back intact
+// SD_PROBE_PASSES times running; the fastest that does is kept
+static const uint32_t stepHz[] = {8000000, 16000000, 20000000, 26000000};
 
 SDItemType classifyFile(const char* name) {
   const char* dot = strrchr(name, '.');
@@ -15,32 +28,128 @@ SDItemType classifyFile(const char* name) {
     return SD_ITEM_JPEG;
   if (strcasecmp(dot, ".md") == 0)
     return SD_ITEM_MARKDOWN;
+  if (strcasecmp(dot, ".q565") == 0)
+    return SD_ITEM_Q565;
   return SD_ITEM_OTHER;
 }
 
-bool sdInit() {
-  Serial.printf("SD: init CS=%d, MISO=%d, MOSI=%d, SCLK=%d\n",
-    SD_CS_PIN, SD_MISO_PIN, TFT_MOSI, TFT_SCLK);
+static bool mountAt(uint32_t hz) {
+  SD.end();
+  if (!SD.begin(SD_CS_PIN, tft.getSPIinstance(), hz)) return false;
+  if (SD.cardType() == CARD_NONE) {
+    SD.end();
+    return false;
+  }
+  clockHz = hz;
+  return true;
+}
 
-  pinMode(SD_CS_PIN, OUTPUT);
-  digitalWrite(SD_CS_PIN, HIGH);
+static uint32_t probeBuf[128];   // one 512 B sector
 
-  // TFT_eSPI initializes HSPI without MISO (displays don't read back).
-  // The ESP32 SPI library guards pin attachment behind an _initted flag,
-  // so calling begin() again won't attach new pins. We must end() first
-  // to reset the flag, then re-begin() with MISO included.
-  SPIClass& spi = tft.getSPIinstance();
-  spi.end();
-  spi.begin(TFT_SCLK, SD_MISO_PIN, TFT_MOSI, -1);
+// Read the SD_PROBE_SECTORS sectors from sector 0 (partition table or
+// boot sector, then reserved space; nothing on the card is written) and
+// hash them with the card's size, FNV-1a.  The hash both names the card
+// (the SPI driver does not expose its CID register) and is what every
+// later read must reproduce.  Sets rate to the read rate in bytes per
+// second; returns 0 if a sector cannot be read.
+static uint32_t readProbe(uint32_t& rate) {
+  uint32_t h = 2166136261u ^ (uint32_t)SD.numSectors();
+  unsigned long startUs = micros();
+  for (uint32_t sector = 0; sector < SD_PROBE_SECTORS; sector++) {
+    if (!SD.readRAW((uint8_t*)probeBuf, sector)) return 0;
+    const uint8_t* p = (const uint8_t*)probeBuf;
+    for (size_t i = 0; i < sizeof(probeBuf); i++) h = (h ^ p[i]) * 16777619u;
+  }
+  unsigned long us = micros() - startUs;
+  rate = (uint32_t)((uint64_t)SD_PROBE_SECTORS * 512 * 1000000 / (us ? us : 1));
+  return h ? h : 1;
+}
+
+// Passes at the current clock, each matching the hash read at the safe
+// clock; returns the slowest pass's rate, 0 on a mismatch
+static uint32_t probeStable() {
+  uint32_t worst = UINT32_MAX;
+  for (int i = 0; i < SD_PROBE_PASSES; i++) {
+    uint32_t rate;
+    if (readProbe(rate) != cardId) return 0;
+    if (rate < worst) worst = rate;
+  }
+  return worst;
+}
+
+// From a working mount at a safe clock, take the card's hash, then try
+// each faster rate in turn and settle on the fastest stable one.  Returns
+// that rate (the base clock if none is faster or the sectors cannot be
+// read).
+static uint32_t stepUp(uint32_t baseHz) {
+  uint32_t rate = 0;
+  cardId = readProbe(rate);
+  if (cardId == 0) {
+    Serial.printf("SD: cannot read the probe sectors, staying at %u MHz\n",
+      (unsigned)(baseHz / 1000000));
+    return baseHz;
+  }
+  Serial.printf("SD: %2u MHz  %4u KB/s (base)\n", (unsigned)(baseHz / 1000000), (unsigned)(rate / 1024));
 
-  // Try mounting at lower frequency first (more reliable for init)
-  Serial.println("SD: attempting mount...");
-  if (!SD.begin(SD_CS_PIN, spi, 4000000)) {
-    Serial.println("SD: mount at 4MHz failed, retrying at 1MHz...");
-    if (!SD.begin(SD_CS_PIN, spi, 1000000)) {
-      Serial.println("SD: mount failed at all speeds");
-      return false;
+  uint32_t best = baseHz;
+  for (uint32_t hz : stepHz) {
+    if (hz <= baseHz) continue;
+    rate = mountAt(hz) ? probeStable() : 0;
+    if (rate == 0) {
+      Serial.printf("SD: %2u MHz  failed verification\n", (unsigned)(hz / 1000000));
+      break;
     }
+    Serial.printf("SD: %2u MHz  %4u KB/s\n", (unsigned)(hz / 1000000), (unsigned)(rate / 1024));
+    best = hz;
+  }
+  if (clockHz != best && !mountAt(best)) mountAt(baseHz);
+  return clockHz;
+}
+
+// Runs on the mount task.  Every card command is an SPI transaction, so
+// the bus lock interleaves them with the TFT's writes from loop().
+static bool mountCard() {
+  // NVS directly, not the state store: that belongs to loop(), and this
+  // is written once per card rather than per press
+  Preferences prefs;
+  prefs.begin("sd", true);
+  uint32_t savedHz = prefs.getUInt("hz", 0);
+  uint32_t savedId = prefs.getUInt("id", 0);
+  prefs.end();
+
+  // The clock this card was stepped up to before, if one pass at it
+  // still reads the card back as the same card
+  bool mounted = false;
+  if (savedHz) {
+    uint32_t rate = 0;
+    uint32_t id = mountAt(savedHz) ? readProbe(rate) : 0;
+    if (id && id == savedId) {
+      Serial.printf("SD: same card, %u MHz from before verified, %u KB/s\n",
+        (unsigned)(savedHz / 1000000), (unsigned)(rate / 1024));
+      cardId = id;
+      mounted = true;
+    } else {
+      // Another card, or this one no longer reads right at that clock
+      Serial.printf("SD: %u MHz from before failed or another card, forgetting it\n",
+        (unsigned)(savedHz / 1000000));
+      prefs.begin("sd", false);
+      prefs.remove("hz");
+      prefs.remove("id");
+      prefs.end();
+    }
+  }
+
+  if (!mounted) {
+    // Try mounting at lower frequency first (more reliable for init)
+    Serial.println("SD: attempting mount...");
+    if (!mountAt(4000000)) {
+      Serial.println("SD: mount at 4MHz failed, retrying at 1MHz...");
+      if (!mountAt(1000000)) {
+        Serial.println("SD: mount failed at all speeds");
+        return false;
+      }
+    }
+    stepPending = true;
   }
 
   uint8_t cardType = SD.cardType();
@@ -51,19 +160,84 @@ bool sdInit() {
     return false;
   }
 
-  ready = true;
-  Serial.printf("SD: %s, %lluMB\n",
+  Serial.printf("SD: %s, %lluMB, %u MHz\n",
     cardType == CARD_MMC ? "MMC" :
     cardType == CARD_SD  ? "SD"  :
     cardType == CARD_SDHC ? "SDHC" : "?",
-    SD.cardSize() / (1024 * 1024));
+    SD.cardSize() / (1024 * 1024), (unsigned)(clockHz / 1000000));
   return true;
 }
 
+static void mountTask(void*) {
+  unsigned long startMs = millis();
+  ready = mountCard();
+  Serial.printf("SD: mount finished in %lu ms\n", millis() - startMs);
+  mountDone = true;
+  xSemaphoreGive(mountSem);
+  vTaskDelete(nullptr);
+}
+
+void sdMountAsync() {
+  Serial.printf("SD: init CS=%d, MISO=%d, MOSI=%d, SCLK=%d\n",
+    SD_CS_PIN, SD_MISO_PIN, TFT_MOSI, TFT_SCLK);
+
+  pinMode(SD_CS_PIN, OUTPUT);
+  digitalWrite(SD_CS_PIN, HIGH);
+
+  // TFT_eSPI initializes HSPI without MISO (displays don't read back).
+  // The ESP32 SPI library guards pin attachment behind an _initted flag,
+  // so calling begin() again won't attach new pins. We must end() first
+  // to reset the flag, then re-begin() with MISO included.  Done here, not
+  // on the task, since nothing may be using the bus while it is re-pinned.
+  SPIClass& spi = tft.getSPIinstance();
+  spi.end();
+  spi.begin(TFT_SCLK, SD_MISO_PIN, TFT_MOSI, -1);
+
+  // Core 0, away from loop() on core 1
+  mountSem = xSemaphoreCreateBinary();
+  if (xTaskCreatePinnedToCore(mountTask, "sdmount", 4096, nullptr, 1, nullptr, 0) != pdPASS) {
+    Serial.println("SD: mount task failed to start");
+    mountDone = true;
+  }
+}
+
+bool sdWait() {
+  if (!mountDone && mountSem) {
+    unsigned long startMs = millis();
+    xSemaphoreTake(mountSem, portMAX_DELAY);
+    Serial.printf("SD: waited %lu ms for the mount\n", millis() - startMs);
+  }
+  return ready;
+}
+
+void sdStepUp() {
+  if (!sdWait() || !stepPending) return;
+  stepPending = false;
+  unsigned long startMs = millis();
+  uint32_t hz = stepUp(clockHz);
+  Serial.printf("SD: stepped up to %u MHz in %lu ms\n", (unsigned)(hz / 1000000),
+    millis() - startMs);
+  if (!cardId) return;
+  // NVS directly, as in mountCard(): once per card
+  Preferences prefs;
+  prefs.begin("sd", false);
+  prefs.putUInt("hz", hz);
+  prefs.putUInt("id", cardId);
+  prefs.end();
+}
+
 bool sdIsReady() {
   return ready;
 }
 
+bool sdMounting() {
+  return mountSem && !mountDone;
+}
+
+uint32_t sdClockHz() {
+  return ready ? clockHz : 0;
+}
+
 SDItemList sdGetItems(const char* folder) {
   SDItemList result;
   result.count = 0;
@@ -7,6 +7,7 @@ enum SDItemType {
   SD_ITEM_NONE = 0,
   SD_ITEM_JPEG,
   SD_ITEM_MARKDOWN,
+  SD_ITEM_Q565,       // display-native image (see q565.h)
   SD_ITEM_DIR,
   SD_ITEM_OTHER
 };
@@ -25,17 +26,43 @@ struct SDItemList {
   int count;
 };
 
-// Initialize SD card on shared HSPI bus (call after tft.init())
-bool sdInit();
+// Start mounting the SD card on the shared HSPI bus from a background task
+// (call right after tft.init(), before anything else is drawn).  Returns at
+// once; the mount and its slow-speed retry run alongside the rest of boot.
+void sdMountAsync();
 
-// Check if SD card is ready
+// Wait for the mount started by sdMountAsync() to finish.  Returns
+// sdIsReady().
+bool sdWait();
+
+// Step the clock of a card mounted at the safe clock up (see sdClockHz())
+// and keep the rate in NVS.  A remount and SD_PROBE_PASSES reads per rate,
+// so Intake calls it behind its own screen; does nothing once done.
+void sdStepUp();
+
+// Check if SD card is ready (false while the mount is still running)
 bool sdIsReady();
 
+// True while the background mount is still running
+bool sdMounting();
+
+// SPI clock the card settled on (0 when not ready).  The fastest stable
+// rate is kept in NVS with a hash of the card's first SD_PROBE_SECTORS
+// sectors; the mount reuses it when one read at that rate gives the same
+// hash, and otherwise forgets it and mounts at 4 (or 1) MHz.  sdStepUp()
+// then tries 8/16/20/26 MHz, each of which must reproduce the hash taken
+// at the safe clock SD_PROBE_PASSES times.  Nothing is written to the card.
+uint32_t sdClockHz();
+
+#define SD_PROBE_SECTORS 32   // 16 KB from sector 0, read with readRAW()
+#define SD_PROBE_PASSES  3
+
 // List items in a folder (e.g. "/birthday")
 SDItemList sdGetItems(const char* folder);
 
 // Get info about a single file by full path
 SDItem sdGetItem(const char* path);
 
-// Classify a filename by extension (.jpg/.jpeg -> JPEG, .md -> MARKDOWN, else OTHER)
+// Classify a filename by extension (.jpg/.jpeg -> JPEG, .md -> MARKDOWN,
+// .q565 -> Q565, else OTHER)
 SDItemType classifyFile(const char* name);
@@ -0,0 +1,109 @@
+#include <Arduino.h>
+#include <Preferences.h>
+#include "state.h"
+
+static Preferences prefs;
+
+struct StateKey {
+  char ns[16];       // NVS names are at most 15 characters
+  char key[16];
+  int32_t value;     // current value
+  int32_t stored;    // what NVS holds
+  bool inNvs;        // the key exists in NVS
+  bool dirty;        // value has to be written
+};
+
+static StateKey keys[STATE_KEYS];
+static int keyCount = 0;
+static bool dirty = false;   // any key dirty
+static unsigned long changedMs = 0;
+
+static StateKey* findKey(const char* ns, const char* key) {
+  for (int i = 0; i < keyCount; i++) {
+    if (strcmp(keys[i].ns, ns) == 0 && strcmp(keys[i].key, key) == 0) return &keys[i];
+  }
+  return nullptr;
+}
+
+// Look a key up, loading it from NVS on first use.  nullptr if the table
+// is full.
+static StateKey* loadKey(const char* ns, const char* key, int32_t def) {
+  StateKey* k = findKey(ns, key);
+  if (k) return k;
+  if (keyCount == STATE_KEYS) return nullptr;
+
+  k = &keys[keyCount++];
+  snprintf(k->ns, sizeof(k->ns), "%s", ns);
+  snprintf(k->key, sizeof(k->key), "%s", key);
+  prefs.begin(ns, true);
+  k->inNvs = prefs.isKey(key);
+  k->stored = prefs.getInt(key, def);
+  prefs.end();
+  k->value = k->stored;
+  k->dirty = false;
+  return k;
+}
+
+int32_t stateGetInt(const char* ns, const char* key, int32_t def) {
+  StateKey* k = loadKey(ns, key, def);
+  if (!k) {
+    // Table full: read straight through
+    prefs.begin(ns, true);
+    int32_t v = prefs.getInt(key, def);
+    prefs.end();
+    return v;
+  }
+  return k->value;
+}
+
+void stateSetInt(const char* ns, const char* key, int32_t value) {
+  StateKey* k = loadKey(ns, key, value);
+  if (!k) {
+    Serial.printf("State: no room for %s/%s, writing through\n", ns, key);
+    prefs.begin(ns, false);
+    prefs.putInt(key, value);
+    prefs.end();
+    return;
+  }
+  k->value = value;
+  // Paging back to the stored value cancels the write
+  k->dirty = !k->inNvs || value != k->stored;
+  if (k->dirty) {
+    dirty = true;
+    changedMs = millis();
+  }
+}
+
+// Write every dirty key now, one begin/end per namespace
+static void stateFlush() {
+  if (!dirty) return;
+  dirty = false;
+
+  int written = 0;
+  for (int i = 0; i < keyCount; i++) {
+    if (!keys[i].dirty) continue;
+    prefs.begin(keys[i].ns, false);
+    for (int j = i; j < keyCount; j++) {
+      StateKey& k = keys[j];
+      if (!k.dirty || strcmp(k.ns, keys[i].ns) != 0) continue;
+      prefs.putInt(k.key, k.value);
+      k.stored = k.value;
+      k.inNvs = true;
+      k.dirty = false;
+      written++;
+    }
+    prefs.end();
+  }
+  if (written) Serial.printf("State: wrote %d key%s\n", written, written == 1 ? "" : "s");
+}
+
+uint32_t stateQuietLeftMs() {
+  if (!dirty) return 0;
+  unsigned long quiet = millis() - changedMs;
+  return quiet >= STATE_QUIET_MS ? 1 : STATE_QUIET_MS - quiet;
+}
+
+void statePoll() {
+  if (dirty && millis() - changedMs >= STATE_QUIET_MS) stateFlush();
+}
+
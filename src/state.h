@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdint.h>
+
+// ============================================================
+// Write-behind store for the small bits of state kept across reboots
+// (current mode, photo, poem).  Values live in RAM; a change only marks
+// its key dirty, and dirty keys go to NVS together once nothing has
+// changed for STATE_QUIET_MS; loop() light-sleeps with a timer wakeup
+// for the rest of that period so the write still happens while idle.
+// Paging quickly through photos therefore writes flash once, for
+// wherever it stops, not once per press.  A value set back to what NVS already holds is not written at all.
+// ============================================================
+
+#define STATE_QUIET_MS 1500   // no changes for this long = write them out
+#define STATE_KEYS     8      // distinct namespace/key pairs
+
+// Read an int, from RAM once the key has been seen (from NVS the first
+// time).  def when the key has never been stored.
+int32_t stateGetInt(const char* ns, const char* key, int32_t def);
+
+// Change an int in RAM; it reaches NVS after the quiet period
+void stateSetInt(const char* ns, const char* key, int32_t value);
+
+// Write dirty keys once they have been quiet long enough.  Cheap when
+// nothing is dirty; call once per loop().
+void statePoll();
+
+// Milliseconds until statePoll() writes the dirty keys (at least 1), or 0
+// when nothing is dirty.  loop() sleeps no longer than this.
+uint32_t stateQuietLeftMs();
@@ -0,0 +1,183 @@
+#include <Arduino.h>
+#include "subpixel.h"
+
+// Byte-swap helper for TFT_eSPI 16-bit sprite buffer (stored swapped for SPI).
+static inline uint16_t bswap16(uint16_t v) { return (v >> 8) | (v << 8); }
+
+#define FRAME_STRIDE (240 / 2)
+
+static inline uint8_t getPixel(const uint8_t* row, int x) {
+  return (row[x >> 1] >> ((~x & 1) << 2)) & 0x0F;
+}
+
+static inline void setPixel(uint8_t* row, int x, uint8_t v) {
+  int shift = (~x & 1) << 2;
+  row[x >> 1] = (row[x >> 1] & ~(0x0F << shift)) | (v << shift);
+}
+
+// Add text color c at `level` coverage steps to frame index d.  Two colors
+// only meet where neighbouring source pixels differ; their coverage then
+// sums to a full pixel, shown in whichever covers more (ties go to c).
+static inline uint8_t addCoverage(uint8_t d, int c, int level) {
+  if (d == 0) return frameIndex(c, level);
+  int dc = (d - 1) / SUBPIXEL_LEVELS + 1, dl = (d - 1) % SUBPIXEL_LEVELS + 1;
+  int sum = dl + level < SUBPIXEL_LEVELS ? dl + level : SUBPIXEL_LEVELS;
+  return frameIndex(dc == c || level >= dl ? c : dc, sum);
+}
+
+// Split a Q16 X into an integer column and a right-hand coverage in levels
+// (0 = exactly on dstXi; offsets within half a level of the next column
+// snap onto it).
+static inline void splitX(int32_t dstXq, int& dstXi, int& q) {
+  dstXi = dstXq >> 16;
+  q = ((dstXq & 0xFFFF) * SUBPIXEL_LEVELS + 0x8000) >> 16;
+  if (q == SUBPIXEL_LEVELS) { dstXi++; q = 0; }
+}
+
+// Palette color of a rendered pixel (fonts are not anti-aliased, so every
+// lit pixel is one of the palette colors; anything else counts as body)
+static inline int colorOf(uint16_t c, const uint16_t* palette) {
+  if (c == palette[1]) return 1;
+  if (c == palette[3]) return 3;
+  return 2;
+}
+
+// Blit 16-bit line sprite into the 4-bit frame with sub-pixel X.  Each
+// source pixel covers SUBPIXEL_LEVELS - q steps of its own column and q of
+// the next; the palette ramps hold the gamma-correct result.
+void subPixelBlit(const uint16_t* srcBuf, int srcW, int srcH, const uint16_t* palette,
+                  uint8_t* dstBuf, int32_t dstXq, int dstY) {
+  if (!srcBuf || !dstBuf) return;
+
+  int dstXi, q;
+  splitX(dstXq, dstXi, q);
+
+  for (int row = 0; row < srcH; row++) {
+    int dy = dstY + row;
+    if (dy < 0 || dy >= 240) continue;
+    const uint16_t* sr = srcBuf + row * SUBPIXEL_SRC_W;
+    uint8_t* dr = dstBuf + dy * FRAME_STRIDE;
+
+    for (int sx = 0; sx < srcW; sx++) {
+      uint16_t cs = sr[sx];
+      if (cs == 0) continue;
+
+      int c = colorOf(bswap16(cs), palette);
+      int dx = dstXi + sx;
+      // Fast path: no fractional offset, just copy
+      if (q == 0) {
+        if (dx >= 0 && dx < 240) setPixel(dr, dx, frameIndex(c, SUBPIXEL_LEVELS));
+        continue;
+      }
+      if (dx >= 0 && dx < 240) setPixel(dr, dx, addCoverage(getPixel(dr, dx), c, SUBPIXEL_LEVELS - q));
+      if (dx + 1 >= 0 && dx + 1 < 240) setPixel(dr, dx + 1, addCoverage(getPixel(dr, dx + 1), c, q));
+    }
+  }
+}
+
+// Reference per-pixel implementation: reads one 2-bit index at a time and
+// blends straight into the destination.
+void subPixelBlitStripScalar(const uint32_t* strip, int strideWords, int srcW, int srcH,
+                             uint8_t* dstBuf, int32_t dstXq, int dstY) {
+  if (!strip || !dstBuf) return;
+
+  int dstXi, q;
+  splitX(dstXq, dstXi, q);
+
+  for (int row = 0; row < srcH; row++) {
+    int dy = dstY + row;
+    if (dy < 0 || dy >= 240) continue;
+    const uint32_t* sr = strip + row * strideWords;
+    uint8_t* dr = dstBuf + dy * FRAME_STRIDE;
+
+    for (int sx = 0; sx < srcW; sx++) {
+      uint32_t idx = (sr[sx >> 4] >> ((sx & 15) * 2)) & 3;
+      if (idx == 0) continue;
+      int dx = dstXi + sx;
+
+      // Fast path: no fractional offset, just copy
+      if (q == 0) {
+        if (dx >= 0 && dx < 240) setPixel(dr, dx, frameIndex(idx, SUBPIXEL_LEVELS));
+        continue;
+      }
+
+      if (dx >= 0 && dx < 240) setPixel(dr, dx, addCoverage(getPixel(dr, dx), idx, SUBPIXEL_LEVELS - q));
+      if (dx + 1 >= 0 && dx + 1 < 240) setPixel(dr, dx + 1, addCoverage(getPixel(dr, dx + 1), idx, q));
+    }
+  }
+}
+
+// Word-at-a-time kernel.  With the span starting as background, every output
+// pixel is a function of just two adjacent source indices (left neighbour's
+// right-hand spill, then this pixel's own left-hand coverage), so the blend
+// collapses into a 16-entry table built once per call, and a frame byte (two
+// output pixels) into a 64-entry table of the three source indices reaching
+// it.  The inner loop is a shift, mask, table load and OR per byte; all-
+// transparent words skip 16 pixels with a single test.
+void subPixelBlitStrip(const uint32_t* strip, int strideWords, int srcW, int srcH,
+                       uint8_t* dstBuf, int32_t dstXq, int dstY) {
+#ifdef SUBPIXEL_SCALAR
+  subPixelBlitStripScalar(strip, strideWords, srcW, srcH, dstBuf, dstXq, dstY);
+#else
+  if (!strip || !dstBuf) return;
+
+  int dstXi, q;
+  splitX(dstXq, dstXi, q);
+  bool frac = q != 0;
+
+  // out[(cur << 2) | prev]: result for a pixel whose source index is cur and
+  // whose left neighbour's source index is prev.  Mirrors the scalar path,
+  // which skips transparent sources entirely.
+  uint8_t out[16];
+  for (int cur = 0; cur < 4; cur++) {
+    for (int prev = 0; prev < 4; prev++) {
+      uint8_t d = 0;
+      if (!frac) {
+        if (cur) d = frameIndex(cur, SUBPIXEL_LEVELS);
+      } else {
+        if (prev) d = addCoverage(d, prev, q);
+        if (cur)  d = addCoverage(d, cur, SUBPIXEL_LEVELS - q);
+      }
+      out[(cur << 2) | prev] = d;
+    }
+  }
+
+  // out2[win]: the byte for output pixels k (high nibble) and k + 1, where
+  // win holds source indices k - 1, k, k + 1 from the low bits up
+  uint8_t out2[64];
+  for (int win = 0; win < 64; win++) out2[win] = out[win & 0xF] << 4 | out[(win >> 2) & 0xF];
+
+  // An odd start column puts output pixel 0 in a low nibble: bytes then
+  // start one pixel early and each window reaches one index further back.
+  // Strip bits past srcW are zero, so the spill pixel and anything after it
+  // come out of the same tables.
+  int par = dstXi & 1;
+  int outputs = srcW + (frac ? 1 : 0) + par;   // fractional blits spill one pixel right
+  int words = (outputs + 15) >> 4;
+  int firstByte = (dstXi - par) >> 1;
+
+  for (int row = 0; row < srcH; row++) {
+    int dy = dstY + row;
+    if (dy < 0 || dy >= 240) continue;
+    const uint32_t* sr = strip + row * strideWords;
+    uint8_t* dr = dstBuf + dy * FRAME_STRIDE;
+    uint32_t prev = 0;   // previous word's last two indices (k = -2, -1)
+
+    for (int wd = 0; wd < words; wd++) {
+      uint32_t word = wd < strideWords ? sr[wd] : 0;
+      if ((word | prev) == 0) continue;
+
+      int b = firstByte + (wd << 3);
+      int j0 = b < 0 ? -b : 0;
+      int j1 = FRAME_STRIDE - b < 8 ? FRAME_STRIDE - b : 8;
+      uint8_t* d = dr + b;
+      if (j0 == 0 && j1 > 0) {
+        d[0] |= out2[(par ? (word << 4) | prev : (word << 2) | (prev >> 2)) & 0x3F];
+      }
+      int shift = 2 + 2 * par;
+      for (int j = j0 ? j0 : 1; j < j1; j++) d[j] |= out2[(word >> (4 * j - shift)) & 0x3F];
+      prev = word >> 28;
+    }
+  }
+#endif
+}
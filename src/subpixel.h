@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stdint.h>
+
+// ============================================================
+// Gamma-correct sub-pixel compositing of a rendered text line into
+// the 240x240 4-bit indexed Poems frame.
+// ============================================================
+
+// Width of a source line row in pixels (line sprite width)
+#define SUBPIXEL_SRC_W 240
+
+// The frame holds two pixels per byte, even X in the high nibble (the
+// layout of a 4-bit TFT_eSprite).  Index 0 is background; each of the three
+// text colors c (1..3) then gets SUBPIXEL_LEVELS coverage steps, so X
+// positions resolve to 1/SUBPIXEL_LEVELS px and every blend lands exactly on
+// a palette entry.  (The RGB332 frame this replaced resolved 1/8 px through
+// a fused source x weight x destination blend table, now gone.)
+#define SUBPIXEL_LEVELS      4
+#define SUBPIXEL_FRAME_BYTES (240 * 240 / 2)
+
+static constexpr uint8_t frameIndex(int color, int level) {
+  return 1 + (color - 1) * SUBPIXEL_LEVELS + (level - 1);
+}
+
+static_assert(frameIndex(3, SUBPIXEL_LEVELS) < 16, "frame palette must fit 4 bits");
+
+// Blit srcW x srcH pixels of a 16-bit (byte-swapped RGB565) line buffer into
+// the frame at fractional X (Q16.16).  Source pixels are matched to their
+// color in palette (4 RGB565 entries, 0 = transparent).
+void subPixelBlit(const uint16_t* src, int srcW, int srcH, const uint16_t* palette,
+                  uint8_t* dst, int32_t dstXq, int dstY);
+
+// Same compositing from a 2-bit palette-indexed strip (16 pixels per 32-bit
+// word, row stride in words; bits past srcW must be 0).  Index 0 is
+// transparent.
+// The destination span must still be background (0): lines never overlap, so
+// the blend reduces to a per-call table and runs a word at a time.
+// Build with -DSUBPIXEL_SCALAR to use the per-pixel reference instead.
+void subPixelBlitStrip(const uint32_t* strip, int strideWords, int srcW, int srcH,
+                       uint8_t* dst, int32_t dstXq, int dstY);
+
+// Per-pixel reference for subPixelBlitStrip (identical output)
+void subPixelBlitStripScalar(const uint32_t* strip, int strideWords, int srcW, int srcH,
+                             uint8_t* dst, int32_t dstXq, int dstY);